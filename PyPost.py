@@ -32,6 +32,68 @@ def readCoord(case_folder, frame_file, coord, nn):
             ixyz = np.fromstring(line, dtype=float, sep=' ')
             coord[i,:] = ixyz
 
+# read the binary trajectory (out_format = 1 or 2), see trajectory_writer.h
+# the coordinates are memory mapped, coord[k] is the (nn x 3) array of frame k, written at step[k]
+def readTrajectory(case_folder):
+    ftraj = case_folder+"trajectory.bin"
+    magic = np.fromfile(ftraj, dtype='S8', count=1)[0]
+    if magic != b"PSTRAJ01":
+        raise Exception(ftraj+" is not a trajectory file")
+    nn, nel, nen, nbytes = np.fromfile(ftraj, dtype=np.int32, count=4, offset=8)
+    conn = np.fromfile(ftraj, dtype=np.int32, count=nel*nen, offset=24).reshape(nel, nen)
+    header = 24 + 4*nel*nen
+    header += header % 8
+
+    real = np.float32 if nbytes == 4 else np.float64
+    frame = np.dtype([('step', np.int64), ('coord', real, (nn, 3))])
+    nframe = (os.path.getsize(ftraj) - header) // frame.itemsize
+    frames = np.memmap(ftraj, dtype=frame, mode='r', offset=header, shape=(nframe,))
+    return conn, frames['step'], frames['coord']
+
+# decode the varints of a frame of the compressed trajectory, see trajectory_codec.h
+def decodeResiduals(buf, count):
+    b = np.frombuffer(buf, dtype=np.uint8).astype(np.uint64)
+    last = np.nonzero(b < 128)[0]
+    if len(last) != count or last[-1] != len(b)-1:
+        raise Exception("corrupted frame of the compressed trajectory")
+    first = np.concatenate(([0], last[:-1]+1))
+    # position of each byte in its varint, 7 bits each
+    shift = np.arange(len(b)) - np.repeat(first, last-first+1)
+    u = np.add.reduceat((b & np.uint64(0x7f)) << (np.uint64(7)*shift.astype(np.uint64)), first)
+    return (u >> np.uint64(1)).astype(np.int64) ^ -(u & np.uint64(1)).astype(np.int64)
+
+# read the compressed trajectory (out_format = 3), see compressed_writer.h
+# returns the same arrays as readTrajectory, the coordinates are decoded into memory
+def readCompressed(case_folder):
+    ftraj = case_folder+"trajectory.psz"
+    with open(ftraj, 'rb') as fin:
+        data = fin.read()
+    if data[:8] != b"PSTRAJZ1":
+        raise Exception(ftraj+" is not a compressed trajectory")
+    nn, nel, nen, nkey = np.frombuffer(data, dtype=np.int32, count=4, offset=8)
+    h = np.frombuffer(data, dtype=np.float64, count=1, offset=24)[0]
+    conn = np.frombuffer(data, dtype=np.int32, count=nel*nen, offset=32).reshape(nel, nen)
+    pos = 32 + 4*nel*nen
+    pos += pos % 8
+
+    steps, coords = [], []
+    q1 = q2 = None
+    while pos < len(data):
+        step = np.frombuffer(data, dtype=np.int64, count=1, offset=pos)[0]
+        order, nbytes = np.frombuffer(data, dtype=np.int32, count=2, offset=pos+8)
+        pos += 16
+        q = decodeResiduals(data[pos:pos+nbytes], 3*nn)
+        pos += nbytes
+        if order == 1:
+            q += q1
+        elif order == 2:
+            q += 2*q1 - q2
+        q2, q1 = q1, q
+        steps.append(step)
+        # component-major to node-major
+        coords.append(h * q.reshape(3, nn).T)
+    return conn, np.array(steps), np.array(coords)
+
 # plot a given frame
 def plotShape(case_folder, coord, conn, nn, nel, iframe, frame_name):
     fig = plt.figure(facecolor='white')
@@ -102,6 +164,20 @@ def plotCase(case_folder, nSide, last_frame_num, step_size=1):
     # nn = (nSide+1) * nSide
     # nel = (nSide)*2 * (nSide-1)         
 
+    # binary trajectory, all frames in one file
+    traj = None
+    if os.path.exists(case_folder+"trajectory.bin"):
+        traj = readTrajectory(case_folder)
+    elif os.path.exists(case_folder+"trajectory.psz"):
+        traj = readCompressed(case_folder)
+    if traj is not None:
+        conn, steps, coords = traj
+        for iframe in range(0, len(steps), step_size):
+            frame_name = "{:0>5d}".format(steps[iframe])
+            plotShape(case_folder, coords[iframe], conn, nn, nel, iframe//step_size+1, frame_name)
+        subprocess.call(["ffmpeg", "-i", case_folder+"frame%05d.png", case_folder+"out.mp4"])
+        return
+
     coord = np.empty((nn,3), dtype=float)
     conn = np.empty((nel,3), dtype=int)
 
@@ -2,6 +2,7 @@
 #define PLATES_SHELLS_ARGUMENTS_H
 
 #include <string>
+#include <vector>
 // #include <filesystem>
 
 enum Opts {
@@ -21,10 +22,23 @@ public:
     std::string data2;              // -p for t, -r for #nodes on width
     std::string inputPath;
     std::string outputPath;
+    bool restart;                   // --restart, continue from the checkpoint of the job
 };
 
 inline Arguments::Arguments(int t_argc, char* argv[])
 {
+    // --restart can be given in any position, the other arguments keep their order
+    std::vector<char*> args;
+    restart = false;
+    for (int i = 0; i < t_argc; i++) {
+        if (std::string(argv[i]) == "--restart")
+            restart = true;
+        else
+            args.push_back(argv[i]);
+    }
+    t_argc = (int) args.size();
+    argv = args.data();
+
     if (t_argc == DEFAULT) {
         type = 0;
         jobName = "Job-11";
@@ -0,0 +1,65 @@
+#ifndef PLATES_SHELLS_ASYNC_WRITER_H
+#define PLATES_SHELLS_ASYNC_WRITER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "type_alias.h"
+
+/*
+ *      Background output writer
+ *
+ *      The solver copies the nodal positions and output fields of a frame into a ring buffer of
+ *      preallocated frames, a writer thread serializes them in order. If all frames are in use,
+ *      the solver either waits for the writer or the new frame is dropped.
+ *      Errors of the writer thread are thrown by the next push(), flush() or by finish().
+ */
+
+class AsyncWriter {
+public:
+    using Serializer = std::function<void(const int ist, const double time, const VectorNodes& nodes,
+                                          const VectorN& fields)>;
+
+    AsyncWriter(const int nframe, const int nn, const bool dropWhenFull, Serializer serializer);
+    ~AsyncWriter();
+
+    void push(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields);
+    void flush();
+    void finish();
+
+    long written() const { return m_written; }
+    long dropped() const { return m_dropped; }
+    double blocked() const { return m_blocked; }
+
+private:
+    struct Frame {
+        int ist;
+        double time;
+        VectorNodes nodes;
+        VectorN fields;
+    };
+
+    void run();
+    void stop();
+
+    Serializer m_serializer;
+    bool m_dropWhenFull;            // true - drop frames if the buffer is full, false - the solver waits
+
+    std::vector<Frame> m_frames;    // ring buffer, frames m_head ... m_head+m_count-1 wait for the writer
+    int m_head;
+    int m_count;
+    bool m_stop;
+    const char* m_error;            // error of the writer thread, nullptr if none
+
+    long m_written;
+    long m_dropped;
+    double m_blocked;               // seconds the solver waited for a free frame
+
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::thread m_thread;
+};
+
+#endif //PLATES_SHELLS_ASYNC_WRITER_H
@@ -2,6 +2,7 @@
 #define PLATES_SHELLS_BENDING_DERIVATIVES_H
 
 #include <Eigen/Dense>
+#include "type_alias.h"
 
 /*
  *      Bending energy
@@ -13,16 +14,20 @@
  *
  */
 
-class Hinge;
-
 class Bending {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-    Bending(Hinge* ptr);
+    // x0 ... x3: hinge nodes (see Hinge::get_node), k: bending coefficient
+    Bending(const Eigen::Vector3d& x0, const Eigen::Vector3d& x1, const Eigen::Vector3d& x2,
+            const Eigen::Vector3d& x3, double k, double psi0);
 
     void initValues();
-    void locBend(Eigen::VectorXd& loc_f, Eigen::MatrixXd& loc_j);
+    void locBend(Vector12d& loc_f, Matrix12d& loc_j);
+    void locBend(Vector12d& loc_f);
+
+    // E_b of the hinge
+    double energy() const { return m_k * (m_psi - m_psi0) * (m_psi - m_psi0); }
 
 private:
     void psi();
@@ -30,12 +35,10 @@ private:
     void xi();
     Eigen::Matrix3d s(Eigen::Matrix3d& mat);
 
-    void grad(Eigen::VectorXd& gradTheta);
-    void hess(Eigen::MatrixXd& hessTheta);
+    void grad(Vector12d& gradTheta);
+    void hess(Matrix12d& hessTheta);
 
 
-    Hinge* m_hinge;
-
     Eigen::Vector3d m_e0;
     Eigen::Vector3d m_e1;
     Eigen::Vector3d m_e2;
@@ -61,6 +64,8 @@ private:
     double m_sinA3;
     double m_sinA4;
 
+    double m_k;
+    double m_psi0;
     double m_psi;
     double m_zeta;
     double m_xi;
@@ -71,6 +76,42 @@ private:
     double m_h4;
     double m_h01;
     double m_h02;
+
+    double m_ne0;           // edge lengths
+    double m_ne1;
+    double m_ne2;
+    double m_ne3;
+    double m_ne4;
+};
+
+/*
+ *      Bending energy of LANES hinges at once
+ *
+ *      Hinge data are gathered into structure-of-arrays lanes, every quantity of the
+ *      scalar Bending class is evaluated by loops over the lanes, which are vectorized
+ *      by the compiler (SSE2/AVX2/AVX-512, depending on the target architecture).
+ *      Local forces and jacobians are stored in the same lanes.
+ */
+
+class BendingBatch {
+public:
+    static const int LANES = 4;
+
+    // x0 ... x3: hinge nodes (see Hinge::get_node), k: bending coefficient
+    void setHinge(const int lane, const Eigen::Vector3d& x0, const Eigen::Vector3d& x1,
+                  const Eigen::Vector3d& x2, const Eigen::Vector3d& x3, const double k, const double psi0);
+    // withJacobian = false: local forces only, m_j is not computed
+    void compute(const bool withJacobian = true);
+    void locBend(const int lane, Vector12d& loc_f, Matrix12d& loc_j) const;
+    void locBend(const int lane, Vector12d& loc_f) const;
+
+private:
+    alignas(64) double m_x[12][LANES];          // nodal positions x0, y0, z0, x1, ...
+    alignas(64) double m_k[LANES];
+    alignas(64) double m_psi0[LANES];
+
+    alignas(64) double m_f[12][LANES];          // local bending force
+    alignas(64) double m_j[12][12][LANES];      // local jacobian matrix
 };
 
 
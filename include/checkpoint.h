@@ -0,0 +1,71 @@
+#ifndef PLATES_SHELLS_CHECKPOINT_H
+#define PLATES_SHELLS_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include "type_alias.h"
+
+/*
+ *      Binary checkpoint of the solver state
+ *
+ *      file    char[8] "PSCHKPT1", uint64 hash of the parameters, uint64 nbytes, uint8 state[nbytes]
+ *
+ *      The solver serializes its state with put() and calls commit(), the file is written by a
+ *      background thread while the solver continues. It goes to a temporary file first, which
+ *      replaces the last checkpoint when complete, a preempted write leaves the last one intact.
+ *      Doubles are stored bit by bit, the restart continues bit-exactly.
+ *      load() reads the file, get() returns the values in the order of put().
+ */
+
+class Checkpoint {
+public:
+    Checkpoint(const std::string& filename, const uint64_t hash);
+    ~Checkpoint();
+
+    // writing
+    void begin();
+    template <typename T>
+    void put(const T& value);
+    void put(const VectorNodes& nodes);
+    void put(const VectorN& vec);
+    void commit();
+    void finish();
+
+    // restart
+    void load();
+    template <typename T>
+    void get(T& value);
+    void get(VectorNodes& nodes);
+    void get(VectorN& vec);
+
+    // FNV-1a hash of the parameters and the reference configuration
+    static void hash(uint64_t& h, const void* data, const size_t nbytes);
+
+private:
+    void write();
+    void putBytes(const void* data, const size_t nbytes);
+    void getBytes(void* data, const size_t nbytes);
+
+    std::string m_filename;
+    uint64_t m_hash;
+
+    std::vector<char> m_buffer;     // state being serialized or read
+    std::vector<char> m_writing;    // state written by the background thread
+    size_t m_pos;                   // read position in m_buffer
+    std::thread m_thread;
+    const char* m_error;            // error of the background thread, nullptr if none
+};
+
+template <typename T>
+void Checkpoint::put(const T& value) {
+    putBytes(&value, sizeof(T));
+}
+
+template <typename T>
+void Checkpoint::get(T& value) {
+    getBytes(&value, sizeof(T));
+}
+
+#endif //PLATES_SHELLS_CHECKPOINT_H
@@ -0,0 +1,47 @@
+#ifndef PLATES_SHELLS_COMPRESSED_WRITER_H
+#define PLATES_SHELLS_COMPRESSED_WRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "type_alias.h"
+
+class Geometry;
+
+/*
+ *      Compressed trajectory, quantized coordinates with an absolute error bound
+ *
+ *      A keyframe every nkey frames, predicted residuals in between, see trajectory_codec.h.
+ *      Native byte order (little endian on all supported platforms):
+ *          header  char[8] "PSTRAJZ1", int32 nn, int32 nel, int32 nen, int32 nkey, float64 h,
+ *                  int32 connectivity[nel x nen] (1-based, as connectivity.txt),
+ *                  zero padding to a multiple of 8 bytes
+ *          frame   int64 step, int32 order, int32 nbytes, uint8 residuals[nbytes]
+ *      Frames have variable size, they are read sequentially by readCompressed() of PyPost.py
+ *      or converted to the binary trajectory by tools/decode_trajectory.
+ *      A restart continues the file of the checkpoint with a keyframe.
+ */
+
+class CompressedWriter {
+public:
+    CompressedWriter(const std::string& filename, const Geometry* SimGeo, const int nkey, const double error,
+                     const long resume = 0);
+
+    void writeFrame(const int ist, const VectorNodes& nodes);
+
+    long bytesWritten() const { return m_bytes; }
+
+private:
+    const Geometry* m_SimGeo;
+    int    m_nkey;                  // frames between keyframes
+    double m_h;                     // quantization step, twice the error bound
+    long   m_frame;                 // frames written
+    long   m_bytes;                 // file size
+
+    std::vector<int64_t> m_q, m_q1, m_q2;   // quantized coordinates of this and the last two frames
+    std::vector<uint8_t> m_buffer;          // residuals of one frame
+    std::ofstream m_file;
+};
+
+#endif //PLATES_SHELLS_COMPRESSED_WRITER_H
@@ -30,7 +30,9 @@ public:
     void set_nedge();
     void set_nhinge();
 
+    void buildTopology();
     void findMassVector();
+    void reorderNodes(const int option);
     void translateNodes(int dir, double amt);
 
     // accessor
@@ -47,6 +49,8 @@ public:
     unsigned int  nel() const;
     unsigned int  nedge() const;
     unsigned int  nhinge() const;
+    int           newNode(const int node) const;
+    int           oldNode(const int node) const;
 
     bool hingeNumCheck() const;
     bool edgeNumCheck() const;
@@ -57,10 +61,28 @@ public:
     double m_mi;                          // mass per node
 
     VectorNodes m_nodes;   // coordinates       (nn  x nsd)
-    VectorMesh m_mesh;     // connectivity      (nel x nen)
+    VectorMesh m_mesh;     // connectivity      (nel x nen), always in the original node numbering
 
     VectorN m_mass;               // nodal mass vector, mx1, my1, mz1, mx2, my2, mz2, ...
-    
+
+    // flat topology used by the solver, 0-based node numbers
+    VectorEdges  m_edges;         // edge nodes        (nedge  x 2)
+    VectorMesh   m_triangles;     // element nodes     (nel    x 3)
+    VectorHinges m_hinges;        // hinge nodes       (nhinge x 4), see Hinge::get_node
+
+    // rest state of the stencils
+    std::vector<double> m_len0;   // edge length              (nedge)
+    std::vector<double> m_area;   // element area             (nel)
+    std::vector<double> m_phi0;   // element angle at node 2  (nel)
+    std::vector<double> m_psi0;   // hinge bending variable   (nhinge)
+    std::vector<double> m_const;  // hinge coefficient, 6 * e0^2 / (A1 + A2)  (nhinge)
+
+    // node reordering, 0-based, both empty if nodes keep the numbering of the mesh generator
+    // m_nodes, m_mass and the flat topology use the new numbers, input and output the old ones
+    std::vector<int> m_newNum;    // new number of each old node
+    std::vector<int> m_oldNum;    // old number of each new node
+
+    // object lists, only used to build the flat topology and released by buildTopology()
     std::vector<Node>    m_nodeList;
     std::vector<Element> m_elementList;
     std::vector<Edge*>   m_edgeList;
@@ -117,7 +139,10 @@ inline unsigned int  Geometry::nel() const                       { return m_nel;
 inline unsigned int  Geometry::nedge() const                     { return m_nedge; }
 inline unsigned int  Geometry::nhinge() const                    { return m_nhinge; }
 
-inline bool Geometry::hingeNumCheck() const                      { return (m_hingeList.size() == m_nhinge); }
-inline bool Geometry::edgeNumCheck() const                       { return (m_edgeList.size() == m_nedge); }
+inline int Geometry::newNode(const int node) const               { return m_newNum.empty() ? node : m_newNum[node]; }
+inline int Geometry::oldNode(const int node) const               { return m_oldNum.empty() ? node : m_oldNum[node]; }
+
+inline bool Geometry::hingeNumCheck() const                      { return (m_hinges.size() == m_nhinge); }
+inline bool Geometry::edgeNumCheck() const                       { return (m_edges.size() == m_nedge); }
 
 #endif //PLATES_SHELLS_GEOMETRY_H
@@ -21,7 +21,6 @@ public:
     double get_psi0() const;
 
     double m_const;
-    double m_k;
 
 private:
     Element* m_el1;
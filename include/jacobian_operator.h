@@ -0,0 +1,111 @@
+#ifndef PLATES_SHELLS_JACOBIAN_OPERATOR_H
+#define PLATES_SHELLS_JACOBIAN_OPERATOR_H
+
+#include <cassert>
+#include "type_alias.h"
+
+class SolverImpl;
+
+/*
+ *      Jacobian of the free dofs as a matrix-free operator
+ *
+ *      J * v is evaluated stencil by stencil from the local jacobians of the current
+ *      configuration (see SolverImpl::multiplyJacobian), the global jacobian is never stored.
+ *      The operator can be used with the iterative solvers of Eigen, together with
+ *      JacobiPreconditioner, which only needs the diagonal of J.
+ */
+
+class JacobianOperator;
+
+namespace Eigen {
+namespace internal {
+    // the operator behaves like a sparse matrix in the expressions of the iterative solvers
+    template<>
+    struct traits<JacobianOperator> : public Eigen::internal::traits<SpMatrix> {};
+}
+}
+
+class JacobianOperator : public Eigen::EigenBase<JacobianOperator> {
+public:
+    typedef double Scalar;
+    typedef double RealScalar;
+    typedef int StorageIndex;
+    enum {
+        ColsAtCompileTime = Eigen::Dynamic,
+        MaxColsAtCompileTime = Eigen::Dynamic,
+        IsRowMajor = false
+    };
+
+    // diag: diagonal of the jacobian of the free dofs
+    JacobianOperator(const SolverImpl* solver, const VectorN& diag)
+        : m_solver(solver), m_diag(diag)
+    {}
+
+    Eigen::Index rows() const { return m_diag.size(); }
+    Eigen::Index cols() const { return m_diag.size(); }
+
+    template<typename Rhs>
+    Eigen::Product<JacobianOperator, Rhs, Eigen::AliasFreeProduct> operator*(const Eigen::MatrixBase<Rhs>& x) const {
+        return Eigen::Product<JacobianOperator, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
+    }
+
+    void multiply(const VectorN& v, VectorN& Jv) const;
+    const VectorN& diagonal() const { return m_diag; }
+
+private:
+    const SolverImpl* m_solver;
+    const VectorN&    m_diag;
+};
+
+namespace Eigen {
+namespace internal {
+    // y += alpha * J * x
+    template<typename Rhs>
+    struct generic_product_impl<JacobianOperator, Rhs, SparseShape, DenseShape, GemvProduct>
+        : generic_product_impl_base<JacobianOperator, Rhs, generic_product_impl<JacobianOperator, Rhs> > {
+
+        typedef typename Product<JacobianOperator, Rhs>::Scalar Scalar;
+
+        template<typename Dest>
+        static void scaleAndAddTo(Dest& dst, const JacobianOperator& lhs, const Rhs& rhs, const Scalar& alpha) {
+            VectorN Jv(lhs.rows());
+            lhs.multiply(rhs, Jv);
+            dst.noalias() += alpha * Jv;
+        }
+    };
+}
+}
+
+// Jacobi preconditioner of the matrix-free operator
+class JacobiPreconditioner {
+public:
+    typedef double Scalar;
+    typedef double RealScalar;
+    typedef int StorageIndex;
+
+    JacobiPreconditioner() : m_isInitialized(false) {}
+
+    template<typename MatType>
+    explicit JacobiPreconditioner(const MatType& mat) { compute(mat); }
+
+    JacobiPreconditioner& analyzePattern(const JacobianOperator&) { return *this; }
+    JacobiPreconditioner& factorize(const JacobianOperator& J) { return compute(J); }
+    JacobiPreconditioner& compute(const JacobianOperator& J) {
+        m_invdiag = J.diagonal().cwiseInverse();
+        m_isInitialized = true;
+        return *this;
+    }
+
+    VectorN solve(const VectorN& b) const {
+        assert(m_isInitialized && "JacobiPreconditioner is not initialized.");
+        return m_invdiag.cwiseProduct(b);
+    }
+
+    Eigen::ComputationInfo info() const { return Eigen::Success; }
+
+private:
+    VectorN m_invdiag;
+    bool m_isInitialized;
+};
+
+#endif //PLATES_SHELLS_JACOBIAN_OPERATOR_H
@@ -0,0 +1,128 @@
+#ifndef PLATES_SHELLS_LINEAR_SOLVER_H
+#define PLATES_SHELLS_LINEAR_SOLVER_H
+
+#include <Eigen/SparseCholesky>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/OrderingMethods>
+#include "type_alias.h"
+#include "jacobian_operator.h"
+
+/*
+ *      Linear solver of the Newton iterations, J * du = rhs
+ *
+ *      J is symmetric, only its upper triangular part is stored. The sparsity pattern of J
+ *      is fixed during the simulation, so the backends may reuse the analysis (ordering,
+ *      symbolic factorization) of the first call of compute().
+ */
+
+// options of linear_solver in input.txt
+enum LinearSolverType {
+    CG_SOLVER      = 0,     // Eigen conjugate gradient, Jacobi preconditioner
+    PARDISO_SOLVER = 1,     // Pardiso sparse direct solver (requires license)
+    LDLT_SOLVER    = 2,     // Eigen simplicial LDLT, AMD ordering
+    LLT_SOLVER     = 3,     // Eigen simplicial LLT, AMD ordering
+    ICCG_SOLVER    = 4,     // Eigen conjugate gradient, incomplete Cholesky preconditioner
+    MFCG_SOLVER    = 5,     // Eigen conjugate gradient on the matrix-free jacobian, Jacobi preconditioner
+    MGCG_SOLVER    = 6,     // conjugate gradient, geometric multigrid preconditioner
+    MG_SOLVER      = 7,     // geometric multigrid V-cycles
+};
+
+class LinearSolver {
+public:
+    virtual ~LinearSolver() {}
+
+    static LinearSolver* create(const int type);
+
+    virtual const char* name() const = 0;
+    virtual void compute(const SpMatrix& A) = 0;
+    virtual void solve(const VectorN& rhs, VectorN& u) = 0;
+
+    // iterative solvers only: relative residual tolerance of the next solves (inexact Newton),
+    // a solve stopped by the iteration limit is accepted afterwards
+    virtual bool iterative() const { return false; }
+    virtual void setTolerance(const double tol) { (void) tol; }
+    virtual long iterations() const { return 0; }      // total number of iterations of all solves
+
+    // matrix-free solvers only: the jacobian is not assembled, solveMatrixFree() replaces compute() and solve()
+    virtual bool matrixFree() const { return false; }
+    virtual void solveMatrixFree(const JacobianOperator& J, const VectorN& rhs, VectorN& u);
+
+    // geometric multigrid only: structured nlen x nwid grid of the mesh generator,
+    // gridDofs is the grid dof (3 * (i * nlen + j) + direction) of each free dof
+    virtual void setGrid(const int nlen, const int nwid, const std::vector<int>& gridDofs) {
+        (void) nlen; (void) nwid; (void) gridDofs;
+    }
+};
+
+// sparse direct solvers of Eigen
+template <typename Decomposition>
+class SimplicialSolver : public LinearSolver {
+public:
+    SimplicialSolver(const char* name)
+        : m_name(name), m_analyzed(false)
+    {}
+
+    const char* name() const override { return m_name; }
+    void compute(const SpMatrix& A) override;
+    void solve(const VectorN& rhs, VectorN& u) override;
+
+private:
+    const char* m_name;
+    bool m_analyzed;
+    Decomposition m_solver;
+};
+
+// preconditioned conjugate gradient of Eigen
+template <typename Preconditioner>
+class CGSolver : public LinearSolver {
+public:
+    CGSolver(const char* name)
+        : m_name(name), m_analyzed(false), m_adaptive(false), m_iterations(0)
+    {}
+
+    const char* name() const override { return m_name; }
+    void compute(const SpMatrix& A) override;
+    void solve(const VectorN& rhs, VectorN& u) override;
+
+    bool iterative() const override { return true; }
+    void setTolerance(const double tol) override;
+    long iterations() const override { return m_iterations; }
+
+private:
+    const char* m_name;
+    bool m_analyzed;
+    bool m_adaptive;                // true once the tolerance is set by setTolerance()
+    long m_iterations;
+    Eigen::ConjugateGradient<SpMatrix, Eigen::Upper, Preconditioner> m_solver;
+};
+
+// conjugate gradient of Eigen on the matrix-free jacobian
+class MatrixFreeCGSolver : public LinearSolver {
+public:
+    MatrixFreeCGSolver()
+        : m_tol(Eigen::NumTraits<double>::epsilon()), m_adaptive(false), m_iterations(0)
+    {}
+
+    const char* name() const override { return "Eigen matrix-free CG"; }
+    void compute(const SpMatrix& A) override;
+    void solve(const VectorN& rhs, VectorN& u) override;
+
+    bool iterative() const override { return true; }
+    void setTolerance(const double tol) override;
+    long iterations() const override { return m_iterations; }
+
+    bool matrixFree() const override { return true; }
+    void solveMatrixFree(const JacobianOperator& J, const VectorN& rhs, VectorN& u) override;
+
+private:
+    double m_tol;
+    bool m_adaptive;                // true once the tolerance is set by setTolerance()
+    long m_iterations;
+};
+
+using LDLTSolver = SimplicialSolver<Eigen::SimplicialLDLT<SpMatrix, Eigen::Upper, Eigen::AMDOrdering<int> > >;
+using LLTSolver  = SimplicialSolver<Eigen::SimplicialLLT<SpMatrix, Eigen::Upper, Eigen::AMDOrdering<int> > >;
+using JacobiCGSolver = CGSolver<Eigen::DiagonalPreconditioner<double> >;
+using ICCGSolver     = CGSolver<Eigen::IncompleteCholesky<double, Eigen::Upper, Eigen::AMDOrdering<int> > >;
+
+#endif //PLATES_SHELLS_LINEAR_SOLVER_H
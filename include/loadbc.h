@@ -44,17 +44,19 @@ public:
     // initialize boundary conditions
     void initBC();
 
-    // check if a given dof with given index is a Dirichlet dof
-    bool inDirichletBC(int index);
+    // check if a given dof with given index is a Dirichlet dof, O(1) lookup in m_dirichletMask
+    bool inDirichletBC(int index) const;
 
     // public variables that will be used by solver
-    std::vector<int>  m_dirichletDofs;               // list of dofs in Dirichlet BC
+    std::vector<int>  m_dirichletDofs;               // sorted list of dofs in Dirichlet BC
+    std::vector<bool> m_dirichletMask;               // true if the dof is in Dirichlet BC, size nn*nsd
     Eigen::VectorXd m_fext;                          // external force vector
 
 private:
     void configForce(const Sets& t_set);
     void configGravity(const int dir, bool sign);    // sign: True-positive, False-Negative
     void findDirichletDofs(const Sets& t_set);
+    void findDirichletMask();
 
     Parameters* m_SimPar;
     Geometry*   m_SimGeo;
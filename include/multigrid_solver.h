@@ -0,0 +1,62 @@
+#ifndef PLATES_SHELLS_MULTIGRID_SOLVER_H
+#define PLATES_SHELLS_MULTIGRID_SOLVER_H
+
+#include <vector>
+#include "linear_solver.h"
+
+/*
+ *      Geometric multigrid of the structured rectangular mesh
+ *
+ *      The mesh generator builds a nlen x nwid grid of nodes, node (i, j) has the number
+ *      i * nlen + j. Every coarse level keeps the even grid lines (and the last one) of the
+ *      finer level, its operator is the Galerkin product P^T * A * P of the bilinear
+ *      prolongation P. Nodal 3x3 blocks are smoothed by symmetric block Gauss-Seidel,
+ *      the coarsest level is solved by a sparse LDLT factorization.
+ *
+ *      The V-cycle is used either as the preconditioner of CG, or as a standalone solver.
+ *      The grid has to be set by setGrid() before the first call of compute().
+ */
+
+class MultigridSolver : public LinearSolver {
+public:
+    MultigridSolver(const bool standalone);
+
+    const char* name() const override;
+    void compute(const SpMatrix& A) override;
+    void solve(const VectorN& rhs, VectorN& u) override;
+
+    bool iterative() const override { return true; }
+    void setTolerance(const double tol) override;
+    long iterations() const override { return m_iterations; }
+
+    void setGrid(const int nlen, const int nwid, const std::vector<int>& gridDofs) override;
+
+private:
+    struct Level {
+        int nlen;                           // grid nodes along the length
+        int nwid;                           // grid nodes along the width
+        std::vector<int> gridDofs;          // grid dof (3 * grid node + direction) of each dof
+        std::vector<int> blockPtr;          // dofs of nodal block b are blockPtr[b] ... blockPtr[b+1]-1
+        std::vector<Eigen::Matrix3d, Eigen::aligned_allocator<Eigen::Matrix3d> > invDiag;   // inverse diagonal blocks
+        SpMatrix A;                         // operator, both triangles stored
+        SpMatrix P;                         // prolongation from the next coarser level
+        SpMatrix R;                         // restriction to the next coarser level, P^T
+    };
+
+    void coarsen(Level& fine, Level& coarse);
+    void findBlocks(Level& level);
+    void findInvDiag(Level& level);
+    void smooth(const Level& level, const VectorN& b, VectorN& x, const bool forward) const;
+    void vcycle(const int l, const VectorN& b, VectorN& x);
+
+    bool   m_standalone;            // true - V-cycles only, false - CG preconditioned by one V-cycle
+    double m_tol;                   // relative residual tolerance
+    bool   m_adaptive;              // true once the tolerance is set by setTolerance()
+    long   m_iterations;
+    bool   m_analyzed;
+
+    std::vector<Level> m_levels;    // finest level first
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>, Eigen::Lower, Eigen::AMDOrdering<int> > m_coarseSolver;
+};
+
+#endif //PLATES_SHELLS_MULTIGRID_SOLVER_H
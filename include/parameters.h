@@ -25,6 +25,30 @@ public:
     void set_thk(const double var);
     void set_vis(const double var);
     void set_gconst(const double var);
+    void set_assemble_op(const int var);
+    void set_linear_solver(const int var);
+    void set_newton_op(const int var);
+    void set_refactor_ratio(const double var);
+    void set_inexact_newton(const int var);
+    void set_forcing_max(const double var);
+    void set_reorder_op(const int var);
+    void set_adaptive_dt(const int var);
+    void set_dt_min(const double var);
+    void set_dt_max(const double var);
+    void set_integrator(const int var);
+    void set_rho_inf(const double var);
+    void set_pd_iter(const int var);
+    void set_relax_op(const int var);
+    void set_relax_iter(const int var);
+    void set_predictor(const int var);
+    void set_checkpoint_freq(const int var);
+    void set_restart(const bool var);
+    void set_out_format(const int var);
+    void set_async_output(const int var);
+    void set_out_buffer(const int var);
+    void set_out_keyframe(const int var);
+    void set_out_error(const double var);
+    void set_out_fields(const int var);
     void set_kstretch();
     void set_kstretch(const double var);
     void set_kshear();
@@ -49,6 +73,30 @@ public:
     double        thk() const;
     double        vis() const;
     double        gconst() const;
+    int           assemble_op() const;
+    int           linear_solver() const;
+    int           newton_op() const;
+    double        refactor_ratio() const;
+    int           inexact_newton() const;
+    double        forcing_max() const;
+    int           reorder_op() const;
+    int           adaptive_dt() const;
+    double        dt_min() const;
+    double        dt_max() const;
+    int           integrator() const;
+    double        rho_inf() const;
+    int           pd_iter() const;
+    int           relax_op() const;
+    int           relax_iter() const;
+    int           predictor() const;
+    int           checkpoint_freq() const;
+    bool          restart() const;
+    int           out_format() const;
+    int           async_output() const;
+    int           out_buffer() const;
+    int           out_keyframe() const;
+    double        out_error() const;
+    int           out_fields() const;
     double        kstretch() const;
     double        kshear() const;
     double        kbend() const;
@@ -71,6 +119,30 @@ private:
     double          thk_;                        // thickness
     double          vis_;                        // viscosity
     double          gconst_;
+    int             assemble_op_;                // assembly option
+    int             linear_solver_;              // linear solver option
+    int             newton_op_;                  // Newton option
+    double          refactor_ratio_;             // residual contraction ratio to refactor jacobian
+    int             inexact_newton_;             // inexact Newton option
+    double          forcing_max_;                // maximum forcing term of inexact Newton
+    int             reorder_op_;                 // node reordering option
+    int             adaptive_dt_;                // 0 - fixed step size, 1 - adaptive step size
+    double          dt_min_;                     // smallest adaptive step size
+    double          dt_max_;                     // largest adaptive step size
+    int             integrator_;                 // 0 - backward Euler, 1 - generalized-alpha, 2 - explicit, 3 - projective dynamics
+    double          rho_inf_;                    // high frequency spectral radius of generalized-alpha
+    int             pd_iter_;                    // local/global iterations of projective dynamics
+    int             relax_op_;                   // 0 - Newton load increments, 1 - FIRE relaxation
+    int             relax_iter_;                 // maximum iterations of FIRE relaxation
+    int             predictor_;                  // predictor of the Newton initial guess, 0 - none, 1 - linear, 2 - quadratic
+    int             checkpoint_freq_;            // steps between checkpoints, 0 - none
+    bool            restart_;                    // continue from the checkpoint, --restart on the command line
+    int             out_format_;                 // 0 - text, 1/2 - binary trajectory float64/float32, 3 - compressed, 4/5 - XDMF float64/float32
+    int             async_output_;               // 0 - synchronous output, 1/2 - writer thread that blocks/drops when full
+    int             out_buffer_;                 // frames of the ring buffer of the output writer thread
+    int             out_keyframe_;               // frames between keyframes of the compressed trajectory
+    double          out_error_;                  // absolute error bound of the compressed trajectory
+    int             out_fields_;                 // fields of the XDMF export, bitmask
     double          ks_;                         // stretch stiffness
     double          ksh_;                        // shearing stiffness
     double          kb_;                         // bending stiffness
@@ -0,0 +1,51 @@
+#ifndef PLATES_SHELLS_PARDISO_SOLVER_H
+#define PLATES_SHELLS_PARDISO_SOLVER_H
+
+#include <vector>
+#include "linear_solver.h"
+
+/* PARDISO prototype. */
+extern "C" void pardisoinit (void   *, int    *,   int *, int *, double *, int *);
+extern "C" void pardiso     (void   *, int    *,   int *, int *,    int *, int *,
+                            double *, int    *,    int *, int *,   int *, int *,
+                            int *, double *, double *, int *, double *);
+
+/*
+ *      Persistent Pardiso solver of a real symmetric matrix (upper triangular part stored)
+ *
+ *      The sparsity pattern of the matrix must not change during the lifetime of the object:
+ *      reordering and symbolic factorization (phase 11) are done in the first call of compute(),
+ *      later calls only do numerical factorization (phase 22).
+ *      Values are read directly from the Eigen matrix, which has to stay alive until solve().
+ */
+
+class PardisoSolver : public LinearSolver {
+public:
+    PardisoSolver();
+    ~PardisoSolver() override;
+
+    const char* name() const override { return "Pardiso"; }
+    void compute(const SpMatrix& A) override;
+    void solve(const VectorN& rhs, VectorN& u) override;
+
+private:
+    void analyze(const SpMatrix& A);
+    void call(int phase, double* b, double* x);
+
+    void*   m_pt[64];               // internal solver memory pointer
+    int     m_iparm[64];            // control parameters
+    double  m_dparm[64];
+    int     m_mtype;                // matrix type
+    int     m_maxfct;               // maximum number of numerical factorizations
+    int     m_mnum;                 // which factorization to use
+    int     m_msglvl;               // print statistical information
+    int     m_nrhs;                 // number of right hand sides
+    int     m_n;                    // number of equations
+    bool    m_analyzed;             // true after phase 11
+
+    std::vector<int> m_ia;          // 1-based row pointers
+    std::vector<int> m_ja;          // 1-based column indices
+    double* m_a;                    // values of the matrix, not owned
+};
+
+#endif //PLATES_SHELLS_PARDISO_SOLVER_H
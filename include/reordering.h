@@ -0,0 +1,39 @@
+#ifndef PLATES_SHELLS_REORDERING_H
+#define PLATES_SHELLS_REORDERING_H
+
+#include <vector>
+#include "type_alias.h"
+
+/*
+ *      Node orderings of the stencil graph
+ *
+ *      Two nodes are adjacent if they share an edge or a hinge, i.e. if their 3x3 block
+ *      of the jacobian is nonzero. An ordering lists the old (0-based) node number of
+ *      every new node number.
+ */
+
+// options of reorder_op in input.txt
+enum ReorderType {
+    NO_REORDER  = 0,        // node numbering of the mesh generator
+    RCM_REORDER = 1,        // reverse Cuthill-McKee, small bandwidth
+    ND_REORDER  = 2,        // nested dissection, small fill of direct solvers
+};
+
+// adjacency of the nodes, neighbors of node i are adj[xadj[i]] ... adj[xadj[i+1]-1]
+struct NodeGraph {
+    std::vector<int> xadj;
+    std::vector<int> adj;
+
+    int nn() const { return (int) xadj.size() - 1; }
+    int degree(const int i) const { return xadj[i+1] - xadj[i]; }
+};
+
+NodeGraph buildNodeGraph(const int nn, const VectorEdges& edges, const VectorHinges& hinges);
+
+std::vector<int> rcmOrdering(const NodeGraph& graph);
+std::vector<int> nestedDissectionOrdering(const NodeGraph& graph);
+
+// largest difference of the numbers of two adjacent nodes, newNum: new number of each old node
+int bandwidth(const NodeGraph& graph, const std::vector<int>& newNum);
+
+#endif //PLATES_SHELLS_REORDERING_H
@@ -2,6 +2,7 @@
 #define PLATES_SHELLS_SHEAR_DERIVATIVES_H
 
 #include <Eigen/Dense>
+#include "type_alias.h"
 
 /*
  *      Shearing energy
@@ -10,21 +11,19 @@
  *
  */
 
-class Element;
-
 class Shearing {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-    Shearing(Element* ptr, double E, double nu, double area, double clen);
+    Shearing(const Eigen::Vector3d& x1, const Eigen::Vector3d& x2, const Eigen::Vector3d& x3,
+             double phi0, double ksh);
     void initValues();
-    void locShear(Eigen::VectorXd& loc_f, Eigen::MatrixXd& loc_j);
+    void locShear(Vector9d& loc_f, Matrix9d& loc_j);
+    void locShear(Vector9d& loc_f);
 
 private:
-    void grad(Eigen::VectorXd& gradPhi);
-    void hess(Eigen::VectorXd& gradPhi, Eigen::MatrixXd& hessPhi);
-
-    Element* m_element;
+    void grad(Vector9d& gradPhi);
+    void hess(Vector9d& gradPhi, Matrix9d& hessPhi);
 
     Eigen::Vector3d m_e1;
     Eigen::Vector3d m_e2;
@@ -32,6 +31,7 @@ private:
     Eigen::Matrix3d m_M2;
 
     double m_phi;
+    double m_phi0;
     double m_ne1;
     double m_ne2;
     double m_h1;
@@ -4,23 +4,22 @@
 #include "type_alias.h"
 
 class Parameters;
-class Node;
-class Element;
 class Geometry;
 class Boundary;
-
-/* PARDISO prototype. */
-extern "C" void pardisoinit (void   *, int    *,   int *, int *, double *, int *);
-extern "C" void pardiso     (void   *, int    *,   int *, int *,    int *, int *, 
-                            double *, int    *,    int *, int *,   int *, int *,
-                            int *, double *, double *, int *, double *);
-
-const int SOLVER_TYPE = 1;      // 0 - Eigen CG solver, 1 - Pardiso
+class LinearSolver;
+class TrajectoryWriter;
+class AsyncWriter;
+class CompressedWriter;
+class XdmfWriter;
+class Checkpoint;
 
 class SolverImpl {
 
+    friend class JacobianOperator;
+
 public:
     SolverImpl(Parameters* SimPar, Geometry* SimGeo, Boundary* SimBC);
+    ~SolverImpl();
 
     void initSolver();
 
@@ -29,7 +28,8 @@ public:
     bool step(const int ist, VectorNodes& x, VectorNodes& x_new, VectorNodes& vel);
     void dynamic();
     void statics();
-    void writeToFiles(const int ist);
+    void relaxation();
+    void writeToFiles(const int ist, const double time, const VectorNodes& vel = VectorNodes());
 
 private:
 
@@ -37,6 +37,12 @@ private:
     Parameters* m_SimPar;
     Geometry*   m_SimGeo;
     Boundary*   m_SimBC;
+    LinearSolver* m_linearSolver;   // backend selected by linear_solver in input.txt
+    TrajectoryWriter* m_trajectory; // binary trajectory, nullptr if the output is written to text files
+    CompressedWriter* m_compressed; // compressed trajectory, nullptr if not selected
+    XdmfWriter* m_xdmf;             // XDMF export, nullptr if not selected
+    AsyncWriter* m_writer;          // background output writer, nullptr if the output is synchronous
+    Checkpoint* m_checkpoint;       // checkpoint for --restart, nullptr if checkpoint_freq = 0 and no restart
 
     // member variables
     unsigned int m_numTotal;
@@ -44,33 +50,150 @@ private:
     unsigned int m_numNeumann;
     double m_tol;
     double m_incRatio;
+    double m_dt;                    // current step size, changed by adaptive stepping
+
+    // generalized-alpha integrator: parameters, and acceleration and energy gradient at t_n
+    double m_alphaM, m_alphaF, m_beta, m_gamma;
+    VectorNodes m_acc;
+    VectorN m_dEdqPrev;
+
+    // projective dynamics: constraint weights and rest states, see findProjectiveSystem()
+    VectorN m_pdShearWeight;        // weight of the shear constraint of each element
+    std::vector<Eigen::Vector4d, Eigen::aligned_allocator<Eigen::Vector4d> > m_pdBendCoeff;  // c_i of each hinge
+    VectorN m_pdBendRest;           // rest value of |sum c_i x_i| of each hinge
+    VectorN m_pdFixed;              // right hand side from the Dirichlet dofs
+    SpMatrix m_pdSystem;            // constant system matrix, factorized once
+
+    // predictor of the Newton initial guess: converged states of the last increments/steps
+    int m_numHistory;               // converged states stored, the predictor falls back to lower orders
+    VectorNodes m_xPrev, m_xPrev2;  // statics: configurations of the last two increments
+    VectorNodes m_velPrev;          // dynamics: velocity of the previous step
+    double m_dtPrev;                // dynamics: size of the previous step
+
+    // Newton statistics, printed at the end of the simulation
+    int m_numIterations;            // total number of Newton iterations (linear solves)
+    int m_numSteps;                 // converged increments or steps
+    int m_numFactorizations;        // total number of jacobian factorizations
+    bool m_factorized;              // true if the linear solver holds a factorization to reuse
+    double m_forcing;               // forcing term of the last inexact Newton iteration
+
+    // fields of the XDMF export, in the element order of the output
+    VectorN m_outFields;            // values of the selected fields of one frame
+    std::vector<int> m_outElement;  // output element of each triangle
+    VectorEdges m_outHinge;         // output elements of each hinge
 
     std::vector<int> m_fullToDofs;
     std::vector<int> m_dofsToFull;
+
+    // jacobian of free dofs, sparsity pattern is built once in initSolver()
+    // NOTE: not assembled by matrix-free solvers, only its diagonal is kept (preconditioner)
+    SpMatrix m_jacobian;
+    VectorN  m_jacobianDiag;
+
+    // scatter maps: position of each local jacobian entry in m_jacobian.valuePtr(), -1 if dropped
+    std::vector<int> m_stretchMap;      // nedge  x (6  x 6)
+    std::vector<int> m_shearMap;        // nel    x (9  x 9)
+    std::vector<int> m_bendMap;         // nhinge x (12 x 12)
+    std::vector<int> m_diagMap;         // position of diagonal entries of free dofs
+
+    // material state: stiffness of each stencil, rebuilt by findMaterialState() when parameters change
+    VectorN m_ks;                   // stretching stiffness of edges,  E * thk / len0^2
+    VectorN m_ksh;                  // shearing stiffness of elements, G * area * thk
+    VectorN m_kb;                   // bending stiffness of hinges,    const * kbend
+    double  m_materialKey[4];       // E, nu, thk, kbend of the current material state
+
+    // stencils grouped by color, stencils with the same color don't share any node
+    // fully constrained stencils are not in the lists
+    // stencils of color c are order[colorPtr[c]] ... order[colorPtr[c+1]-1]
+    std::vector<int> m_edgeOrder,    m_edgeColorPtr;
+    std::vector<int> m_elementOrder, m_elementColorPtr;
+    std::vector<int> m_hingeOrder,   m_hingeColorPtr;
     
     // solver flags
     bool DYNAMIC_SOLVER;        // true - dynamic solver, false - static solver
     bool WRITE_OUTPUT;          // true - write output, false - no output, configured in input.txt
     bool INFO_STYLE;            // true - print info on console, false - progress bar + log file
+    bool PARALLEL_ASSEMBLY;     // true - graph colored multithreaded assembly, false - serial assembly
+    bool MODIFIED_NEWTON;       // true - lagged jacobian, refactored only on slow convergence
+    bool INEXACT_NEWTON;        // true - tolerance of the iterative linear solver from the Newton residuals
+    bool MATRIX_FREE;           // true - jacobian is not assembled, only products J * v are evaluated
+    bool ADAPTIVE_STEP;         // true - step size control of the dynamic solver
+    bool GEN_ALPHA;             // true - generalized-alpha integrator, false - backward Euler
+    bool EXPLICIT;              // true - explicit symplectic Euler, no jacobian and no linear solver
+    bool PROJECTIVE;            // true - projective dynamics, constant prefactored system matrix
+    bool RELAXATION;            // true - static equilibrium by FIRE relaxation instead of Newton increments
+    bool GRADIENT_ONLY;         // true - no jacobian and no linear solver (explicit or relaxation)
 
     // subroutine
-    void findDEnergy(VectorN& dEdq, SparseEntries& entries_full);
+    void findDEnergy(VectorN& dEdq, SpMatrix& jacobian);
     // static
     void findResidual(const int ist, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs);
     // dynamic
     void findResidual(const VectorNodes& vel, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs);
-    void findJacobian(SparseEntries& entries_full, SpMatrix& jacobian);
-    void findDofnew(const VectorN& rhs, SpMatrix& jacobian, VectorNodes& x_new);
-
-    // solver functions
-    void sparseSolver(const SpMatrix& A, const VectorN& rhs, VectorN& u);
-    void pardisoInterface(SpMatrix& A, const VectorN& rhs, VectorN& u);
+    // dynamic, generalized-alpha
+    void findResidualAlpha(const VectorNodes& vel, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs);
+    void initAlphaState(const VectorNodes& vel);
+    void updateAlphaState(const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorNodes& vel);
+    // dynamic, explicit
+    void explicitStep(VectorNodes& x, VectorNodes& vel);
+    double findStableStep() const;
+    void findStiffnessRowSums(VectorN& rowsum) const;
+    // dynamic, projective dynamics
+    void projectiveStep(VectorNodes& x, VectorNodes& vel);
+    void findProjectiveSystem();
+    void projectConstraints(VectorN& rhs) const;
+    // predictor of the Newton initial guess
+    void predict(const VectorNodes& x, VectorNodes& x_new) const;
+    void predict(const VectorNodes& x, VectorNodes& x_new, const VectorNodes& vel) const;
+    void findJacobian(SpMatrix& jacobian);
+    void findDofnew(const VectorN& rhs, SpMatrix& jacobian, VectorNodes& x_new, const bool refactor);
+    bool refactorJacobian(const int niter, const double error, const double error_prev) const;
+    double findForcingTerm(const int niter, const double error, const double error_prev);
+
+    // matrix-free jacobian
+    double findDiagonalTerm(const int idof) const;
+    void findJacobianDiagonal(VectorN& diag) const;
+    void multiplyJacobian(const VectorN& v, VectorN& Jv) const;
+    template <typename Func>
+    void forEachLocalJacobian(Func func) const;
+    void printNewtonStats() const;
+
+    // output
+    void writeFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields);
+    void finishOutput();
+    void findOutputMaps();
+    void findOutputFields(const int ist, const VectorNodes& vel, VectorN& fields);
+
+    // checkpoint and restart
+    uint64_t findStateHash() const;
+    void writeCheckpoint(const int ist, const double time, const int counter, const VectorNodes& x, const VectorNodes& vel);
+    void readCheckpoint(int& ist, double& time, int& counter, VectorNodes& x, VectorNodes& vel);
+
+    // adaptive stepping
+    bool tryStep(const int ist, VectorNodes& x, VectorNodes& x_new, VectorNodes& vel);
+    void adaptStepSize(const int niter, const VectorNodes& vel_prev, const VectorNodes& vel);
+    void setStepSize(const double dt);
 
     // helper functions
     void findMappingVectors();
-    void DEStretch(VectorN& dEdq, SparseEntries& entries_full);
-    void DEShear  (VectorN& dEdq, SparseEntries& entries_full);
-    void DEBend   (VectorN& dEdq, SparseEntries& entries_full);
+    void findGrid();
+    void findSparsityPattern();
+    void findScatterMap(const int* nodes, const int nnode, std::vector<int>& map);
+    int  findValueIndex(const int row, const int col) const;
+    void findMaterialState();
+    bool materialChanged() const;
+    void findColoring();
+    bool stencilConstrained(const int* nodes, const int nnode) const;
+    void colorStencils(const int* nodes, const int nstencil, const int nnode,
+                       std::vector<int>& order, std::vector<int>& colorPtr);
+    void DEStretch(VectorN& dEdq, double* jac);
+    void DEShear  (VectorN& dEdq, double* jac);
+    void DEBend   (VectorN& dEdq, double* jac);
+    void DEStretchEdge  (const int k, VectorN& dEdq, double* jac);
+    void DEShearElement (const int k, VectorN& dEdq, double* jac);
+    void DEBendHinge    (const int k, VectorN& dEdq, double* jac);
+    void DEBendBatch    (const int* hinges, VectorN& dEdq, double* jac);
+    void scatterBend    (const int k, const Vector12d& loc_f, const Matrix12d& loc_j, VectorN& dEdq, double* jac);
 };
 
 #endif //PLATES_SHELLS_SOLVER_H
@@ -2,6 +2,7 @@
 #define PLATES_SHELLS_DERIVATIVES_H
 
 #include <Eigen/Dense>
+#include "type_alias.h"
 
 /*
  *      Stretch energy
@@ -13,24 +14,22 @@
  *
  */
 
-class Edge;
-
 class Stretching {
 public:
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-    Stretching(Edge* ptr, double E, double T);
+    Stretching(const Eigen::Vector3d& x1, const Eigen::Vector3d& x2, double len0, double ks);
 
-    void locStretch(Eigen::VectorXd& loc_f, Eigen::MatrixXd& loc_j);
+    void locStretch(Vector6d& loc_f, Matrix6d& loc_j);
+    void locStretch(Vector6d& loc_f);
 
 private:
-    void grad(Eigen::VectorXd& gradLen);
-    void hess(Eigen::MatrixXd& hessLen);
-
-    Edge* m_edge;
+    void grad(Vector6d& gradLen);
+    void hess(Matrix6d& hessLen);
 
     Eigen::Vector3d m_ne0;
     double m_len;           // Current length of edge
+    double m_len0;          // Original length of edge
     double m_ks;            // Stretching stiffness
 };
 
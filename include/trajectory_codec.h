@@ -0,0 +1,32 @@
+#ifndef PLATES_SHELLS_TRAJECTORY_CODEC_H
+#define PLATES_SHELLS_TRAJECTORY_CODEC_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+ *      Coding of the frames of the compressed trajectory (out_format = 3)
+ *
+ *      Coordinates are quantized, q = round(x / h) with h = 2 * error bound. A frame stores
+ *      the residuals of q against a prediction from the previous frames of its group:
+ *          order 0 (keyframe)  0
+ *          order 1             q1
+ *          order 2             2 * q1 - q2         (constant velocity)
+ *      Residuals are zigzag encoded and written as LEB128 varints in component-major order
+ *      (x of all nodes, then y, then z), small motions take one byte per coordinate.
+ *      The predictions use the quantized values of the previous frames, errors don't accumulate.
+ *      Shared by CompressedWriter and the decoder tool (tools/decode_trajectory).
+ */
+
+namespace TrajectoryCodec {
+
+    const char MAGIC[8] = {'P', 'S', 'T', 'R', 'A', 'J', 'Z', '1'};
+
+    void encodeFrame(const std::vector<int64_t>& q, const std::vector<int64_t>& q1,
+                     const std::vector<int64_t>& q2, const int order, std::vector<uint8_t>& bytes);
+    void decodeFrame(const uint8_t* bytes, const size_t nbytes, const std::vector<int64_t>& q1,
+                     const std::vector<int64_t>& q2, const int order, std::vector<int64_t>& q);
+}
+
+#endif //PLATES_SHELLS_TRAJECTORY_CODEC_H
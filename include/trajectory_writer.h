@@ -0,0 +1,45 @@
+#ifndef PLATES_SHELLS_TRAJECTORY_WRITER_H
+#define PLATES_SHELLS_TRAJECTORY_WRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "type_alias.h"
+
+class Geometry;
+
+/*
+ *      Binary trajectory, all output frames of a simulation in a single file
+ *
+ *      Native byte order (little endian on all supported platforms):
+ *          header  char[8] "PSTRAJ01", int32 nn, int32 nel, int32 nen, int32 bytes per coordinate (4 or 8),
+ *                  int32 connectivity[nel x nen] (1-based, as connectivity.txt),
+ *                  zero padding to a multiple of 8 bytes
+ *          frame   int64 step, float32/float64 coordinates[nn x 3]
+ *      Nodes are in the original numbering of the mesh generator. All frames have the same size,
+ *      so the file is read with np.memmap (readTrajectory() of PyPost.py), the number of frames
+ *      follows from the file size.
+ *      A restart continues the file of the checkpoint, frames written after it are removed.
+ */
+
+class TrajectoryWriter {
+public:
+    TrajectoryWriter(const std::string& filename, const Geometry* SimGeo, const bool single, const long resume = 0);
+
+    void writeFrame(const int ist, const VectorNodes& nodes);
+
+    long bytesWritten() const { return m_bytes; }
+
+private:
+    template <typename Real>
+    void packFrame(const int ist, const VectorNodes& nodes);
+
+    const Geometry* m_SimGeo;
+    bool m_single;                  // true - float32 coordinates, false - float64
+    long m_bytes;                   // file size
+    std::ofstream m_file;
+    std::vector<char> m_buffer;     // one frame, written by a single call
+};
+
+#endif //PLATES_SHELLS_TRAJECTORY_WRITER_H
@@ -9,8 +9,18 @@
 
 using VectorNodes = std::vector<Eigen::Vector3d, Eigen::aligned_allocator<Eigen::Vector3d> >;
 using VectorMesh = std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> >;
+using VectorEdges = std::vector<Eigen::Vector2i, Eigen::aligned_allocator<Eigen::Vector2i> >;
+using VectorHinges = std::vector<Eigen::Vector4i, Eigen::aligned_allocator<Eigen::Vector4i> >;
 using VectorN = Eigen::VectorXd;
 using SpMatrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
 using SparseEntries = std::vector<Eigen::Triplet<double> >;
 
+// fixed-size local vectors/matrices of stretch (2 nodes), shear (3 nodes) and bending (4 nodes) stencils
+using Vector6d  = Eigen::Matrix<double, 6, 1>;
+using Vector9d  = Eigen::Matrix<double, 9, 1>;
+using Vector12d = Eigen::Matrix<double, 12, 1>;
+using Matrix6d  = Eigen::Matrix<double, 6, 6>;
+using Matrix9d  = Eigen::Matrix<double, 9, 9>;
+using Matrix12d = Eigen::Matrix<double, 12, 12>;
+
 #endif // TYPE_ALIAS_H
\ No newline at end of file
@@ -2,6 +2,11 @@
 #define PLATES_SHELLS_UTILITIES_H
 
 #include <chrono>
+#include <cstring>
+#include <cstdint>
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+#include <Eigen/Core>
+#endif
 
 class Timer
 {
@@ -37,4 +42,43 @@ class Timer
         std::chrono::system_clock::time_point m_ltime;
 };
 
+// false for NaN and inf, from the exponent bits: std::isfinite is folded to true under
+// -ffinite-math-only, which is implied by the -Ofast of the release builds
+inline bool finiteValue(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x7ff0000000000000ULL) != 0x7ff0000000000000ULL;
+}
+
+// no heap allocation is allowed while this object is alive
+// NOTE: only checked when built with -DEIGEN_RUNTIME_NO_MALLOC (Eigen asserts on any allocation)
+// the flag of Eigen is global to the process, the scope must only be active in serial code
+class NoMallocScope
+{
+    public:
+        NoMallocScope(bool ACTIVE = true)
+            : m_active(ACTIVE)
+        {
+            if (m_active)
+                allow(false);
+        }
+        ~NoMallocScope()
+        {
+            if (m_active)
+                allow(true);
+        }
+    private:
+        static void allow(bool ALLOWED)
+        {
+#ifdef EIGEN_RUNTIME_NO_MALLOC
+            Eigen::internal::set_is_malloc_allowed(ALLOWED);
+#else
+            (void) ALLOWED;
+#endif
+        }
+
+        bool m_active;
+};
+
 #endif //PLATES_SHELLS_UTILITIES_H
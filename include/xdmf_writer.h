@@ -0,0 +1,57 @@
+#ifndef PLATES_SHELLS_XDMF_WRITER_H
+#define PLATES_SHELLS_XDMF_WRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "type_alias.h"
+
+class Geometry;
+
+/*
+ *      XDMF export for ParaView, light XML data with the heavy data in raw binary files
+ *
+ *      topology.bin    int32 connectivity[nel x 3] (0-based, element order of connectivity.txt),
+ *                      written once and referenced by every frame
+ *      trajectory.raw  frame: int64 step, float64 time, float32/float64 coordinates[nn x 3], fields
+ *      trajectory.xmf  temporal collection of the frames, each frame points to its coordinates
+ *                      and fields in trajectory.raw by a byte offset (Seek)
+ *      The time of a frame is the simulated time of the dynamic solver, the increment for statics.
+ *      Fields are selected by out_fields, in this order: velocity [nn x 3], residual force [nn x 3],
+ *      area strain [nel], bending energy [nel], nodes in the original numbering.
+ *      The XML is complete after every frame, a running simulation can be opened in ParaView.
+ *      A restart continues trajectory.raw of the checkpoint and rebuilds the XML of its frames.
+ */
+
+class XdmfWriter {
+public:
+    enum Field { VELOCITY = 1, FORCE = 2, STRAIN = 4, BENDING = 8 };
+
+    XdmfWriter(const std::string& path, const Geometry* SimGeo, const bool single, const int fields,
+               const long resume = 0);
+
+    void writeFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields);
+
+    long bytesWritten() const { return m_bytes; }
+
+    // number of field values per frame
+    static int fieldSize(const int fields, const int nn, const int nel);
+
+private:
+    template <typename Real>
+    void packFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields);
+    void writeGrid(const int ist, const double time, const long offset);
+
+    const Geometry* m_SimGeo;
+    bool m_single;                  // true - float32 coordinates and fields, false - float64
+    int  m_fields;                  // bitmask of Field
+    long m_bytes;                   // size of trajectory.raw
+    long m_frameBytes;              // size of a frame in trajectory.raw
+    std::ofstream m_raw;
+    std::ofstream m_xml;
+    std::streampos m_tail;          // position of the closing tags in the XML
+    std::vector<char> m_buffer;     // one frame, written by a single call
+};
+
+#endif //PLATES_SHELLS_XDMF_WRITER_H
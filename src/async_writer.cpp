@@ -0,0 +1,105 @@
+#include <iostream>
+#include <algorithm>
+
+#include "async_writer.h"
+#include "utilities.h"
+
+AsyncWriter::AsyncWriter(const int nframe, const int nn, const bool dropWhenFull, Serializer serializer)
+    : m_serializer(serializer), m_dropWhenFull(dropWhenFull), m_head(0), m_count(0), m_stop(false),
+      m_error(nullptr), m_written(0), m_dropped(0), m_blocked(0.0)
+{
+    if (nframe < 1)
+        throw "the output buffer needs at least one frame";
+    m_frames.resize(nframe);
+    for (auto &frame : m_frames)
+        frame.nodes.resize(nn);
+    m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+// pending frames are still written
+AsyncWriter::~AsyncWriter() {
+    stop();
+}
+
+// copy of the nodal positions and fields, the solver continues as soon as a frame is free
+void AsyncWriter::push(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_error)
+        throw m_error;
+    if (m_count == m_frames.size()) {
+        if (m_dropWhenFull) {
+            m_dropped++;
+            return;
+        }
+        Timer t;
+        m_notFull.wait(lock, [this] { return m_count < m_frames.size() || m_error; });
+        m_blocked += 1e-3 * t.elapsed();
+        if (m_error)
+            throw m_error;
+    }
+
+    Frame& frame = m_frames[(m_head + m_count) % m_frames.size()];
+    frame.ist = ist;
+    frame.time = time;
+    std::copy(nodes.begin(), nodes.end(), frame.nodes.begin());
+    frame.fields = fields;
+    m_count++;
+    m_notEmpty.notify_one();
+}
+
+// waits until all frames are written, the writer thread continues
+void AsyncWriter::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notFull.wait(lock, [this] { return m_count == 0 || m_error; });
+    if (m_error)
+        throw m_error;
+}
+
+// waits until all frames are written, the writer thread is stopped
+void AsyncWriter::finish() {
+    stop();
+    if (m_error)
+        throw m_error;
+}
+
+void AsyncWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_notEmpty.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+// the frame at the head stays in use until it is serialized
+void AsyncWriter::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_notEmpty.wait(lock, [this] { return m_count > 0 || m_stop; });
+        if (m_count == 0)
+            return;
+
+        Frame& frame = m_frames[m_head];
+        lock.unlock();
+        const char* error = nullptr;
+        try {
+            m_serializer(frame.ist, frame.time, frame.nodes, frame.fields);
+        }
+        catch (const char* msg) {
+            error = msg;
+        }
+        lock.lock();
+
+        if (error) {
+            std::cerr << error << " in the output writer thread" << std::endl;
+            m_error = error;
+            m_notFull.notify_one();
+            return;
+        }
+        m_head = (m_head + 1) % m_frames.size();
+        m_count--;
+        m_written++;
+        m_notFull.notify_one();
+    }
+}
@@ -1,7 +1,5 @@
 #include <cmath>
 #include "bending.h"
-#include "hinge.h"
-#include "node.h"
 
 //         x2
 //         /\
@@ -24,46 +22,56 @@
 
 // -----------------------------------------------------------------------
 
-Bending::Bending(Hinge* ptr) {
-    m_hinge = ptr;
-
-    m_e0 = *(m_hinge->get_node(1)->get_xyz()) - *(m_hinge->get_node(0)->get_xyz());
-    m_e1 = *(m_hinge->get_node(2)->get_xyz()) - *(m_hinge->get_node(0)->get_xyz());
-    m_e2 = *(m_hinge->get_node(3)->get_xyz()) - *(m_hinge->get_node(0)->get_xyz());
-    m_e3 = *(m_hinge->get_node(2)->get_xyz()) - *(m_hinge->get_node(1)->get_xyz());
-    m_e4 = *(m_hinge->get_node(3)->get_xyz()) - *(m_hinge->get_node(1)->get_xyz());
+Bending::Bending(const Eigen::Vector3d& x0, const Eigen::Vector3d& x1, const Eigen::Vector3d& x2,
+                 const Eigen::Vector3d& x3, double k, double psi0)
+    : m_k(k), m_psi0(psi0)
+{
+    m_e0 = x1 - x0;
+    m_e1 = x2 - x0;
+    m_e2 = x3 - x0;
+    m_e3 = x2 - x1;
+    m_e4 = x3 - x1;
     initValues();
 }
 
 void Bending::initValues() {
-    m_cosA1 = m_e0.dot(m_e1) / (m_e0.norm() * m_e1.norm());
-    m_cosA2 = m_e0.dot(m_e2) / (m_e0.norm() * m_e2.norm());
-    m_cosA3 = -m_e0.dot(m_e3) / (m_e0.norm() * m_e3.norm());
-    m_cosA4 = -m_e0.dot(m_e4) / (m_e0.norm() * m_e4.norm());
+    m_ne0 = m_e0.norm();
+    m_ne1 = m_e1.norm();
+    m_ne2 = m_e2.norm();
+    m_ne3 = m_e3.norm();
+    m_ne4 = m_e4.norm();
 
-    m_sinA1 = (m_e0.cross(m_e1)).norm() / (m_e0.norm() * m_e1.norm());
-    m_sinA2 = (m_e0.cross(m_e2)).norm() / (m_e0.norm() * m_e2.norm());
-    m_sinA3 = (-m_e0.cross(m_e3)).norm() / (m_e0.norm() * m_e3.norm());
-    m_sinA4 = (-m_e0.cross(m_e4)).norm() / (m_e0.norm() * m_e4.norm());
+    m_cosA1 = m_e0.dot(m_e1) / (m_ne0 * m_ne1);
+    m_cosA2 = m_e0.dot(m_e2) / (m_ne0 * m_ne2);
+    m_cosA3 = -m_e0.dot(m_e3) / (m_ne0 * m_ne3);
+    m_cosA4 = -m_e0.dot(m_e4) / (m_ne0 * m_ne4);
 
+    // e0 x e1 = e0 x e3, e0 x e2 = e0 x e4
     m_nn1 = m_e0.cross(m_e3);
-    m_nn1 = m_nn1 / (m_nn1.norm());
     m_nn2 = -m_e0.cross(m_e4);
-    m_nn2 = m_nn2 / (m_nn2.norm());
-
-    m_m1 = (m_nn1).cross(m_e1 / m_e1.norm());
-    m_m2 = -(m_nn2).cross(m_e2 / m_e2.norm());
-    m_m3 = -(m_nn1).cross(m_e3 / m_e3.norm());
-    m_m4 = (m_nn2).cross(m_e4 / m_e4.norm());
-    m_m01 = -(m_nn1).cross(m_e0 / m_e0.norm());
-    m_m02 = (m_nn2).cross(m_e0 / m_e0.norm());
-
-    m_h1 = m_e0.norm() * m_sinA1;
-    m_h2 = m_e0.norm() * m_sinA2;
-    m_h3 = m_e0.norm() * m_sinA3;
-    m_h4 = m_e0.norm() * m_sinA4;
-    m_h01 = m_e1.norm() * m_sinA1;
-    m_h02 = m_e2.norm() * m_sinA2;
+    double nn1 = m_nn1.norm();
+    double nn2 = m_nn2.norm();
+    m_nn1 = m_nn1 / nn1;
+    m_nn2 = m_nn2 / nn2;
+
+    m_sinA1 = nn1 / (m_ne0 * m_ne1);
+    m_sinA2 = nn2 / (m_ne0 * m_ne2);
+    m_sinA3 = nn1 / (m_ne0 * m_ne3);
+    m_sinA4 = nn2 / (m_ne0 * m_ne4);
+
+    m_m1 = (m_nn1).cross(m_e1 / m_ne1);
+    m_m2 = -(m_nn2).cross(m_e2 / m_ne2);
+    m_m3 = -(m_nn1).cross(m_e3 / m_ne3);
+    m_m4 = (m_nn2).cross(m_e4 / m_ne4);
+    m_m01 = -(m_nn1).cross(m_e0 / m_ne0);
+    m_m02 = (m_nn2).cross(m_e0 / m_ne0);
+
+    m_h1 = m_ne0 * m_sinA1;
+    m_h2 = m_ne0 * m_sinA2;
+    m_h3 = m_ne0 * m_sinA3;
+    m_h4 = m_ne0 * m_sinA4;
+    m_h01 = m_ne1 * m_sinA1;
+    m_h02 = m_ne2 * m_sinA2;
 
     psi();
     zeta();
@@ -72,9 +80,9 @@ void Bending::initValues() {
 
 // -----------------------------------------------------------------------
 
-void Bending::locBend(Eigen::VectorXd &loc_f, Eigen::MatrixXd &loc_j) {
-    Eigen::VectorXd gradTheta = Eigen::VectorXd::Zero(12);
-    Eigen::MatrixXd hessTheta = Eigen::MatrixXd::Zero(12, 12);
+void Bending::locBend(Vector12d &loc_f, Matrix12d &loc_j) {
+    Vector12d gradTheta;
+    Matrix12d hessTheta;
 
     grad(gradTheta);
     hess(hessTheta);
@@ -83,6 +91,13 @@ void Bending::locBend(Eigen::VectorXd &loc_f, Eigen::MatrixXd &loc_j) {
     loc_j = m_zeta * hessTheta + m_xi * gradTheta * gradTheta.transpose();
 }
 
+// force only, for the explicit integrator
+void Bending::locBend(Vector12d &loc_f) {
+    Vector12d gradTheta;
+    grad(gradTheta);
+    loc_f = m_zeta * gradTheta;
+}
+
 // -----------------------------------------------------------------------
 
 void Bending::psi() {
@@ -96,25 +111,25 @@ void Bending::psi() {
 }
 
 void Bending::zeta() {
-    m_zeta = 2.0 * m_hinge->m_k * (m_psi - m_hinge->get_psi0()) * (1 + pow(m_psi, 2));
+    m_zeta = 2.0 * m_k * (m_psi - m_psi0) * (1 + pow(m_psi, 2));
 }
 
 void Bending::xi() {
-    m_xi = m_hinge->m_k * (1 + pow(m_psi, 2)) * (2 * (m_psi - m_hinge->get_psi0()) * m_psi + (1 + pow(m_psi, 2)));
+    m_xi = m_k * (1 + pow(m_psi, 2)) * (2 * (m_psi - m_psi0) * m_psi + (1 + pow(m_psi, 2)));
 }
 
 Eigen::Matrix3d Bending::s(Eigen::Matrix3d &mat) {
     return (mat + mat.transpose());
 }
 
-void Bending::grad(Eigen::VectorXd& gradTheta) {
-    gradTheta.segment(0, 3) = m_cosA3 * m_nn1 / m_h3 + m_cosA4 * m_nn2 / m_h4;
-    gradTheta.segment(3, 3) = m_cosA1 * m_nn1 / m_h1 + m_cosA2 * m_nn2 / m_h2;
-    gradTheta.segment(6, 3) = - m_nn1 / m_h01;
-    gradTheta.segment(9, 3) = - m_nn2 / m_h02;
+void Bending::grad(Vector12d& gradTheta) {
+    gradTheta.segment<3>(0) = m_cosA3 * m_nn1 / m_h3 + m_cosA4 * m_nn2 / m_h4;
+    gradTheta.segment<3>(3) = m_cosA1 * m_nn1 / m_h1 + m_cosA2 * m_nn2 / m_h2;
+    gradTheta.segment<3>(6) = - m_nn1 / m_h01;
+    gradTheta.segment<3>(9) = - m_nn2 / m_h02;
 }
 
-void Bending::hess(Eigen::MatrixXd& hessTheta) {
+void Bending::hess(Matrix12d& hessTheta) {
     Eigen::Matrix3d M331 = m_cosA3 / (m_h3 * m_h3) * m_m3 * m_nn1.transpose();
     Eigen::Matrix3d M311 = m_cosA3 / (m_h3 * m_h1) * m_m1 * m_nn1.transpose();
     Eigen::Matrix3d M131 = m_cosA1 / (m_h1 * m_h3) * m_m3 * m_nn1.transpose();
@@ -129,8 +144,8 @@ void Bending::hess(Eigen::MatrixXd& hessTheta) {
     Eigen::Matrix3d M222 = m_cosA2 / (m_h2 * m_h2) * m_m2 * m_nn2.transpose();
     Eigen::Matrix3d M2022 = m_cosA2 / (m_h2 * m_h02) * m_m02 * m_nn2.transpose();
 
-    Eigen::Matrix3d B1 = 1 / (pow(m_e0.norm(), 2)) * m_nn1 * m_m01.transpose();
-    Eigen::Matrix3d B2 = 1 / (pow(m_e0.norm(), 2)) * m_nn2 * m_m02.transpose();
+    Eigen::Matrix3d B1 = 1 / (m_ne0 * m_ne0) * m_nn1 * m_m01.transpose();
+    Eigen::Matrix3d B2 = 1 / (m_ne0 * m_ne0) * m_nn2 * m_m02.transpose();
 
     Eigen::Matrix3d N13 = 1 / (m_h01 * m_h3) * m_nn1 * m_m3.transpose();
     Eigen::Matrix3d N24 = 1 / (m_h02 * m_h4) * m_nn2 * m_m4.transpose();
@@ -139,20 +154,245 @@ void Bending::hess(Eigen::MatrixXd& hessTheta) {
     Eigen::Matrix3d N101 = 1 / (m_h01 * m_h01) * m_nn1 * m_m01.transpose();
     Eigen::Matrix3d N202 = 1 / (m_h02 * m_h02) * m_nn2 * m_m02.transpose();
 
-    hessTheta.block(0,0, 3,3) = s(M331) - B1 + s(M442) - B2;
-    hessTheta.block(0,3, 3,3) = M311 + M131.transpose() + B1 + M422 + M242.transpose() + B2;
-    hessTheta.block(0,6, 3,3) = M3011 - N13;
-    hessTheta.block(0,9, 3,3) = M4022 - N24;
-    hessTheta.block(3,3, 3,3) = s(M111) - B1 + s(M222) - B2;
-    hessTheta.block(3,6, 3,3) = M1011 - N11;
-    hessTheta.block(3,9, 3,3) = M2022 - N22;
-    hessTheta.block(6,6, 3,3) = -s(N101);
-    hessTheta.block(9,9, 3,3) = -s(N202);
+    hessTheta.block<3,3>(0,0) = s(M331) - B1 + s(M442) - B2;
+    hessTheta.block<3,3>(0,3) = M311 + M131.transpose() + B1 + M422 + M242.transpose() + B2;
+    hessTheta.block<3,3>(0,6) = M3011 - N13;
+    hessTheta.block<3,3>(0,9) = M4022 - N24;
+    hessTheta.block<3,3>(3,3) = s(M111) - B1 + s(M222) - B2;
+    hessTheta.block<3,3>(3,6) = M1011 - N11;
+    hessTheta.block<3,3>(3,9) = M2022 - N22;
+    hessTheta.block<3,3>(6,6) = -s(N101);
+    hessTheta.block<3,3>(9,9) = -s(N202);
+    hessTheta.block<3,3>(6,9).setZero();
 
     // symmetric matrix
-    hessTheta.block(3,0, 3,3) = (hessTheta.block(0,3, 3,3)).transpose();
-    hessTheta.block(6,0, 3,3) = (hessTheta.block(0,6, 3,3)).transpose();
-    hessTheta.block(9,0, 3,3) = (hessTheta.block(0,9, 3,3)).transpose();
-    hessTheta.block(6,3, 3,3) = (hessTheta.block(3,6, 3,3)).transpose();
-    hessTheta.block(9,3, 3,3) = (hessTheta.block(3,9, 3,3)).transpose();
-}
\ No newline at end of file
+    hessTheta.block<3,3>(3,0) = (hessTheta.block<3,3>(0,3)).transpose();
+    hessTheta.block<3,3>(6,0) = (hessTheta.block<3,3>(0,6)).transpose();
+    hessTheta.block<3,3>(9,0) = (hessTheta.block<3,3>(0,9)).transpose();
+    hessTheta.block<3,3>(6,3) = (hessTheta.block<3,3>(3,6)).transpose();
+    hessTheta.block<3,3>(9,3) = (hessTheta.block<3,3>(3,9)).transpose();
+    hessTheta.block<3,3>(9,6).setZero();
+}
+
+// -----------------------------------------------------------------------
+//      Batched version
+// -----------------------------------------------------------------------
+
+void BendingBatch::setHinge(const int lane, const Eigen::Vector3d& x0, const Eigen::Vector3d& x1,
+                            const Eigen::Vector3d& x2, const Eigen::Vector3d& x3, const double k, const double psi0) {
+    for (int i = 0; i < 3; i++) {
+        m_x[i][lane]   = x0[i];
+        m_x[i+3][lane] = x1[i];
+        m_x[i+6][lane] = x2[i];
+        m_x[i+9][lane] = x3[i];
+    }
+    m_k[lane] = k;
+    m_psi0[lane] = psi0;
+}
+
+void BendingBatch::locBend(const int lane, Vector12d& loc_f, Matrix12d& loc_j) const {
+    for (int i = 0; i < 12; i++) {
+        loc_f(i) = m_f[i][lane];
+        for (int j = 0; j < 12; j++)
+            loc_j(i,j) = m_j[i][j][lane];
+    }
+}
+
+void BendingBatch::locBend(const int lane, Vector12d& loc_f) const {
+    for (int i = 0; i < 12; i++)
+        loc_f(i) = m_f[i][lane];
+}
+
+// helpers on lanes, the innermost loops run over the lanes and are vectorized
+static const int L = BendingBatch::LANES;
+
+static inline void lane_sub(const double a[3][L], const double b[3][L], double c[3][L]) {
+    for (int i = 0; i < 3; i++)
+        #pragma omp simd
+        for (int l = 0; l < L; l++)
+            c[i][l] = a[i][l] - b[i][l];
+}
+
+static inline void lane_dot(const double a[3][L], const double b[3][L], double c[L]) {
+    #pragma omp simd
+    for (int l = 0; l < L; l++)
+        c[l] = a[0][l]*b[0][l] + a[1][l]*b[1][l] + a[2][l]*b[2][l];
+}
+
+// c = sign * (a x b) / scale
+static inline void lane_cross(const double a[3][L], const double b[3][L], const double scale[L],
+                              const double sign, double c[3][L]) {
+    for (int i = 0; i < 3; i++) {
+        int p = (i+1) % 3, q = (i+2) % 3;
+        #pragma omp simd
+        for (int l = 0; l < L; l++)
+            c[i][l] = sign * (a[p][l]*b[q][l] - a[q][l]*b[p][l]) / scale[l];
+    }
+}
+
+// same formulation as Bending::initValues, grad, hess and locBend, one hinge per lane
+void BendingBatch::compute(const bool withJacobian) {
+    alignas(64) double one[L], e0[3][L], e1[3][L], e2[3][L], e3[3][L], e4[3][L];
+    alignas(64) double ne0[L], ne1[L], ne2[L], ne3[L], ne4[L];
+    alignas(64) double cosA1[L], cosA2[L], cosA3[L], cosA4[L];
+    alignas(64) double nn1[3][L], nn2[3][L], c1[L], c2[L];
+    alignas(64) double m1[3][L], m2[3][L], m3[3][L], m4[3][L], m01[3][L], m02[3][L];
+    alignas(64) double h1[L], h2[L], h3[L], h4[L], h01[L], h02[L];
+    alignas(64) double zeta[L], xi[L], g[12][L];
+
+    const double (*x0)[L] = &m_x[0];
+    const double (*x1)[L] = &m_x[3];
+    const double (*x2)[L] = &m_x[6];
+    const double (*x3)[L] = &m_x[9];
+
+    // edges and their lengths
+    lane_sub(x1, x0, e0);
+    lane_sub(x2, x0, e1);
+    lane_sub(x3, x0, e2);
+    lane_sub(x2, x1, e3);
+    lane_sub(x3, x1, e4);
+    lane_dot(e0, e0, ne0);
+    lane_dot(e1, e1, ne1);
+    lane_dot(e2, e2, ne2);
+    lane_dot(e3, e3, ne3);
+    lane_dot(e4, e4, ne4);
+    #pragma omp simd
+    for (int l = 0; l < L; l++) {
+        one[l] = 1.0;
+        ne0[l] = sqrt(ne0[l]);
+        ne1[l] = sqrt(ne1[l]);
+        ne2[l] = sqrt(ne2[l]);
+        ne3[l] = sqrt(ne3[l]);
+        ne4[l] = sqrt(ne4[l]);
+    }
+
+    // angles at x0 and x1
+    lane_dot(e0, e1, cosA1);
+    lane_dot(e0, e2, cosA2);
+    lane_dot(e0, e3, cosA3);
+    lane_dot(e0, e4, cosA4);
+    #pragma omp simd
+    for (int l = 0; l < L; l++) {
+        cosA1[l] =  cosA1[l] / (ne0[l] * ne1[l]);
+        cosA2[l] =  cosA2[l] / (ne0[l] * ne2[l]);
+        cosA3[l] = -cosA3[l] / (ne0[l] * ne3[l]);
+        cosA4[l] = -cosA4[l] / (ne0[l] * ne4[l]);
+    }
+
+    // unit normals, nn1 = e0 x e3, nn2 = - e0 x e4
+    lane_cross(e0, e3, one,  1.0, nn1);
+    lane_cross(e0, e4, one, -1.0, nn2);
+    lane_dot(nn1, nn1, c1);
+    lane_dot(nn2, nn2, c2);
+    #pragma omp simd
+    for (int l = 0; l < L; l++) {
+        c1[l] = sqrt(c1[l]);
+        c2[l] = sqrt(c2[l]);
+    }
+    for (int i = 0; i < 3; i++) {
+        #pragma omp simd
+        for (int l = 0; l < L; l++) {
+            nn1[i][l] /= c1[l];
+            nn2[i][l] /= c2[l];
+        }
+    }
+
+    // heights, sinA1 = c1 / (ne0 * ne1), etc.
+    #pragma omp simd
+    for (int l = 0; l < L; l++) {
+        h1[l] = c1[l] / ne1[l];
+        h2[l] = c2[l] / ne2[l];
+        h3[l] = c1[l] / ne3[l];
+        h4[l] = c2[l] / ne4[l];
+        h01[l] = c1[l] / ne0[l];
+        h02[l] = c2[l] / ne0[l];
+    }
+
+    lane_cross(nn1, e1, ne1,  1.0, m1);
+    lane_cross(nn2, e2, ne2, -1.0, m2);
+    lane_cross(nn1, e3, ne3, -1.0, m3);
+    lane_cross(nn2, e4, ne4,  1.0, m4);
+    lane_cross(nn1, e0, ne0, -1.0, m01);
+    lane_cross(nn2, e0, ne0,  1.0, m02);
+
+    // psi, zeta, xi
+    #pragma omp simd
+    for (int l = 0; l < L; l++) {
+        double crs0 = nn1[1][l]*nn2[2][l] - nn1[2][l]*nn2[1][l];
+        double crs1 = nn1[2][l]*nn2[0][l] - nn1[0][l]*nn2[2][l];
+        double crs2 = nn1[0][l]*nn2[1][l] - nn1[1][l]*nn2[0][l];
+        double angleSign = (e0[0][l]*crs0 + e0[1][l]*crs1 + e0[2][l]*crs2 > 0) ? 1.0 : -1.0;
+        double d0 = nn1[0][l] - nn2[0][l], d1 = nn1[1][l] - nn2[1][l], d2 = nn1[2][l] - nn2[2][l];
+        double s0 = nn1[0][l] + nn2[0][l], s1 = nn1[1][l] + nn2[1][l], s2 = nn1[2][l] + nn2[2][l];
+        double psi = angleSign * sqrt(d0*d0 + d1*d1 + d2*d2) / sqrt(s0*s0 + s1*s1 + s2*s2);
+        zeta[l] = 2.0 * m_k[l] * (psi - m_psi0[l]) * (1 + psi*psi);
+        xi[l] = m_k[l] * (1 + psi*psi) * (2 * (psi - m_psi0[l]) * psi + (1 + psi*psi));
+    }
+
+    // gradient of theta
+    for (int i = 0; i < 3; i++) {
+        #pragma omp simd
+        for (int l = 0; l < L; l++) {
+            g[i][l]   = cosA3[l] * nn1[i][l] / h3[l] + cosA4[l] * nn2[i][l] / h4[l];
+            g[i+3][l] = cosA1[l] * nn1[i][l] / h1[l] + cosA2[l] * nn2[i][l] / h2[l];
+            g[i+6][l] = - nn1[i][l] / h01[l];
+            g[i+9][l] = - nn2[i][l] / h02[l];
+        }
+    }
+
+    if (!withJacobian) {
+        for (int i = 0; i < 12; i++) {
+            #pragma omp simd
+            for (int l = 0; l < L; l++)
+                m_f[i][l] = zeta[l] * g[i][l];
+        }
+        return;
+    }
+
+    // hessian of theta, upper blocks (see Bending::hess), stored in m_j
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            #pragma omp simd
+            for (int l = 0; l < L; l++) {
+                double B1 = nn1[r][l] * m01[c][l] / (ne0[l] * ne0[l]);
+                double B2 = nn2[r][l] * m02[c][l] / (ne0[l] * ne0[l]);
+                m_j[r][c][l]     = cosA3[l] / (h3[l] * h3[l]) * (m3[r][l]*nn1[c][l] + nn1[r][l]*m3[c][l]) - B1
+                                 + cosA4[l] / (h4[l] * h4[l]) * (m4[r][l]*nn2[c][l] + nn2[r][l]*m4[c][l]) - B2;
+                m_j[r][c+3][l]   = cosA3[l] / (h3[l] * h1[l]) * m1[r][l]*nn1[c][l]
+                                 + cosA1[l] / (h1[l] * h3[l]) * nn1[r][l]*m3[c][l] + B1
+                                 + cosA4[l] / (h4[l] * h2[l]) * m2[r][l]*nn2[c][l]
+                                 + cosA2[l] / (h2[l] * h4[l]) * nn2[r][l]*m4[c][l] + B2;
+                m_j[r][c+6][l]   = cosA3[l] / (h3[l] * h01[l]) * m01[r][l]*nn1[c][l]
+                                 - 1 / (h01[l] * h3[l]) * nn1[r][l]*m3[c][l];
+                m_j[r][c+9][l]   = cosA4[l] / (h4[l] * h02[l]) * m02[r][l]*nn2[c][l]
+                                 - 1 / (h02[l] * h4[l]) * nn2[r][l]*m4[c][l];
+                m_j[r+3][c+3][l] = cosA1[l] / (h1[l] * h1[l]) * (m1[r][l]*nn1[c][l] + nn1[r][l]*m1[c][l]) - B1
+                                 + cosA2[l] / (h2[l] * h2[l]) * (m2[r][l]*nn2[c][l] + nn2[r][l]*m2[c][l]) - B2;
+                m_j[r+3][c+6][l] = cosA1[l] / (h1[l] * h01[l]) * m01[r][l]*nn1[c][l]
+                                 - 1 / (h01[l] * h1[l]) * nn1[r][l]*m1[c][l];
+                m_j[r+3][c+9][l] = cosA2[l] / (h2[l] * h02[l]) * m02[r][l]*nn2[c][l]
+                                 - 1 / (h02[l] * h2[l]) * nn2[r][l]*m2[c][l];
+                m_j[r+6][c+6][l] = - 1 / (h01[l] * h01[l]) * (nn1[r][l]*m01[c][l] + m01[r][l]*nn1[c][l]);
+                m_j[r+6][c+9][l] = 0.0;
+                m_j[r+9][c+9][l] = - 1 / (h02[l] * h02[l]) * (nn2[r][l]*m02[c][l] + m02[r][l]*nn2[c][l]);
+            }
+        }
+    }
+
+    // local force and jacobian, lower blocks from symmetry
+    for (int i = 0; i < 12; i++) {
+        #pragma omp simd
+        for (int l = 0; l < L; l++)
+            m_f[i][l] = zeta[l] * g[i][l];
+        for (int j = i/3*3; j < 12; j++) {
+            #pragma omp simd
+            for (int l = 0; l < L; l++)
+                m_j[i][j][l] = zeta[l] * m_j[i][j][l] + xi[l] * g[i][l] * g[j][l];
+        }
+        for (int j = i/3*3 + 3; j < 12; j++) {
+            #pragma omp simd
+            for (int l = 0; l < L; l++)
+                m_j[j][i][l] = m_j[i][j][l];
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#include "checkpoint.h"
+
+static const char MAGIC[8] = {'P', 'S', 'C', 'H', 'K', 'P', 'T', '1'};
+
+Checkpoint::Checkpoint(const std::string& filename, const uint64_t hash)
+    : m_filename(filename), m_hash(hash), m_pos(0), m_error(nullptr)
+{}
+
+// a running write is completed
+Checkpoint::~Checkpoint() {
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void Checkpoint::begin() {
+    m_buffer.clear();
+}
+
+void Checkpoint::put(const VectorNodes& nodes) {
+    uint64_t n = nodes.size();
+    put(n);
+    for (auto &node : nodes)
+        putBytes(node.data(), 3 * sizeof(double));
+}
+
+void Checkpoint::put(const VectorN& vec) {
+    uint64_t n = vec.size();
+    put(n);
+    putBytes(vec.data(), n * sizeof(double));
+}
+
+// the last write has to be completed before its buffer is reused
+void Checkpoint::commit() {
+    finish();
+    m_writing.swap(m_buffer);
+    m_thread = std::thread(&Checkpoint::write, this);
+}
+
+void Checkpoint::finish() {
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_error)
+        throw m_error;
+}
+
+void Checkpoint::write() {
+    std::string tmpname = m_filename + ".tmp";
+    {
+        std::ofstream file(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+        uint64_t nbytes = m_writing.size();
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char*>(&m_hash), sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&nbytes), sizeof(uint64_t));
+        file.write(m_writing.data(), nbytes);
+        file.close();
+        if (!file) {
+            m_error = "writing the checkpoint failed";
+            return;
+        }
+    }
+    if (std::rename(tmpname.c_str(), m_filename.c_str()) != 0)
+        m_error = "writing the checkpoint failed";
+}
+
+void Checkpoint::load() {
+    std::ifstream file(m_filename.c_str(), std::ios::binary);
+    if (!file)
+        throw "cannot open the checkpoint file";
+
+    char magic[8];
+    uint64_t hash, nbytes;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&hash), sizeof(uint64_t));
+    file.read(reinterpret_cast<char*>(&nbytes), sizeof(uint64_t));
+    if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw "not a checkpoint file";
+    if (hash != m_hash)
+        throw "the checkpoint was written with different parameters";
+
+    m_buffer.resize(nbytes);
+    file.read(m_buffer.data(), nbytes);
+    if (!file)
+        throw "the checkpoint file is truncated";
+    m_pos = 0;
+}
+
+void Checkpoint::get(VectorNodes& nodes) {
+    uint64_t n;
+    get(n);
+    nodes.resize(n);
+    for (auto &node : nodes)
+        getBytes(node.data(), 3 * sizeof(double));
+}
+
+void Checkpoint::get(VectorN& vec) {
+    uint64_t n;
+    get(n);
+    vec.resize(n);
+    getBytes(vec.data(), n * sizeof(double));
+}
+
+void Checkpoint::hash(uint64_t& h, const void* data, const size_t nbytes) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < nbytes; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+void Checkpoint::putBytes(const void* data, const size_t nbytes) {
+    const char* bytes = static_cast<const char*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + nbytes);
+}
+
+void Checkpoint::getBytes(void* data, const size_t nbytes) {
+    if (m_pos + nbytes > m_buffer.size())
+        throw "the checkpoint file is truncated";
+    std::memcpy(data, m_buffer.data() + m_pos, nbytes);
+    m_pos += nbytes;
+}
@@ -0,0 +1,77 @@
+#include <cmath>
+#include <algorithm>
+#include <unistd.h>
+
+#include "compressed_writer.h"
+#include "trajectory_codec.h"
+#include "geometry.h"
+
+// resume: size of the file at the checkpoint of a restart, 0 - new file
+CompressedWriter::CompressedWriter(const std::string& filename, const Geometry* SimGeo, const int nkey, const double error,
+                                   const long resume)
+    : m_SimGeo(SimGeo), m_nkey(nkey), m_h(2.0 * error), m_frame(0), m_bytes(resume)
+{
+    if (nkey < 1)
+        throw "out_keyframe must be positive";
+    if (!(error > 0.0))
+        throw "out_error must be positive";
+    m_q.resize(3 * m_SimGeo->nn());
+
+    if (resume > 0) {
+        if (truncate(filename.c_str(), resume) != 0)
+            throw "cannot continue the trajectory file of the checkpoint";
+        m_file.open(filename.c_str(), std::ios::binary | std::ios::app);
+        if (!m_file)
+            throw "cannot open the trajectory file";
+        return;
+    }
+
+    m_file.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file)
+        throw "cannot open the trajectory file";
+
+    std::vector<int32_t> header = {(int32_t) m_SimGeo->nn(), (int32_t) m_SimGeo->nel(),
+                                   (int32_t) m_SimGeo->nen(), m_nkey};
+    std::vector<int32_t> conn;
+    for (int i = 0; i < m_SimGeo->nel(); i++) {
+        for (int j = 0; j < m_SimGeo->nen(); j++)
+            conn.push_back(m_SimGeo->m_mesh[i][j]);
+    }
+    // frames start at a multiple of 8 bytes
+    if (conn.size() % 2 != 0)
+        conn.push_back(0);
+
+    m_file.write(TrajectoryCodec::MAGIC, sizeof(TrajectoryCodec::MAGIC));
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(int32_t));
+    m_file.write(reinterpret_cast<const char*>(&m_h), sizeof(double));
+    m_file.write(reinterpret_cast<const char*>(conn.data()), conn.size() * sizeof(int32_t));
+    m_file.flush();
+    m_bytes = sizeof(TrajectoryCodec::MAGIC) + (header.size() + conn.size()) * sizeof(int32_t) + sizeof(double);
+}
+
+void CompressedWriter::writeFrame(const int ist, const VectorNodes& nodes) {
+    // component-major order of the coordinates, nodes in the original numbering
+    int nn = m_SimGeo->nn();
+    for (int k = 0; k < nn; k++) {
+        const Eigen::Vector3d& node = nodes[m_SimGeo->newNode(k)];
+        for (int j = 0; j < 3; j++)
+            m_q[j * nn + k] = std::llround(node[j] / m_h);
+    }
+
+    int order = (int) std::min(m_frame % m_nkey, 2L);
+    TrajectoryCodec::encodeFrame(m_q, m_q1, m_q2, order, m_buffer);
+
+    int64_t step = ist;
+    int32_t record[2] = {order, (int32_t) m_buffer.size()};
+    m_file.write(reinterpret_cast<const char*>(&step), sizeof(int64_t));
+    m_file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+    m_file.flush();
+    if (!m_file)
+        throw "writing the trajectory file failed";
+    m_bytes += sizeof(int64_t) + sizeof(record) + m_buffer.size();
+
+    m_q2.swap(m_q1);
+    m_q1 = m_q;
+    m_frame++;
+}
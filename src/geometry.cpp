@@ -1,6 +1,7 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <algorithm>
 
 #include "geometry.h"
 #include "parameters.h"
@@ -8,6 +9,7 @@
 #include "element.h"
 #include "edge.h"
 #include "hinge.h"
+#include "reordering.h"
 
 Geometry::Geometry(Parameters* SimPar)
     : m_datum(0), m_nsd(0), m_nen(0), m_rec_len(0), m_rec_wid(0), m_num_nodes_len(0), m_num_nodes_wid(0),
@@ -23,6 +25,113 @@ Geometry::~Geometry() {
         delete *ihinge;
 }
 
+// copy node numbers and rest state of the edge, element and hinge lists into contiguous arrays,
+// then release the object lists
+void Geometry::buildTopology() {
+    m_edges.resize(m_edgeList.size());
+    m_len0.resize(m_edgeList.size());
+    for (int k = 0; k < m_edgeList.size(); k++) {
+        Edge* iedge = m_edgeList[k];
+        m_edges[k] << iedge->get_node_num(1)-1, iedge->get_node_num(2)-1;
+        m_len0[k] = iedge->get_len0();
+    }
+
+    m_triangles.resize(m_elementList.size());
+    m_area.resize(m_elementList.size());
+    m_phi0.resize(m_elementList.size());
+    for (int k = 0; k < m_elementList.size(); k++) {
+        Element& iel = m_elementList[k];
+        m_triangles[k] << iel.get_node_num(1)-1, iel.get_node_num(2)-1, iel.get_node_num(3)-1;
+        m_area[k] = iel.get_area();
+        m_phi0[k] = iel.get_phi0();
+    }
+
+    m_hinges.resize(m_hingeList.size());
+    m_psi0.resize(m_hingeList.size());
+    m_const.resize(m_hingeList.size());
+    for (int k = 0; k < m_hingeList.size(); k++) {
+        Hinge* ihinge = m_hingeList[k];
+        m_hinges[k] << ihinge->get_node_num(0)-1, ihinge->get_node_num(1)-1,
+                       ihinge->get_node_num(2)-1, ihinge->get_node_num(3)-1;
+        m_psi0[k] = ihinge->get_psi0();
+        m_const[k] = ihinge->m_const;
+    }
+
+    for (std::vector<Edge*>::iterator iedge = m_edgeList.begin(); iedge != m_edgeList.end(); iedge++)
+        delete *iedge;
+    for (std::vector<Hinge*>::iterator ihinge = m_hingeList.begin(); ihinge != m_hingeList.end(); ihinge++)
+        delete *ihinge;
+    std::vector<Edge*>().swap(m_edgeList);
+    std::vector<Hinge*>().swap(m_hingeList);
+    std::vector<Element>().swap(m_elementList);
+    std::vector<Node>().swap(m_nodeList);
+}
+
+// renumber the nodes for cache locality and small fill of the jacobian factorization,
+// stencils are sorted by their smallest node number
+// NOTE: must be called after findMassVector(), which uses the grid numbering
+void Geometry::reorderNodes(const int option) {
+    if (option == NO_REORDER)
+        return;
+
+    NodeGraph graph = buildNodeGraph(m_nn, m_edges, m_hinges);
+    std::vector<int> identity(m_nn);
+    for (int i = 0; i < m_nn; i++)
+        identity[i] = i;
+    int bw_old = bandwidth(graph, identity);
+
+    if (option == RCM_REORDER)
+        m_oldNum = rcmOrdering(graph);
+    else if (option == ND_REORDER)
+        m_oldNum = nestedDissectionOrdering(graph);
+    else
+        throw "unknown node reordering, check reorder_op in input.txt";
+
+    m_newNum.resize(m_nn);
+    for (int i = 0; i < m_nn; i++)
+        m_newNum[m_oldNum[i]] = i;
+    std::cout << "nodes reordered, bandwidth " << bw_old << " -> " << bandwidth(graph, m_newNum) << std::endl;
+
+    // nodal arrays
+    VectorNodes nodes(m_nn);
+    VectorN mass(m_nn * m_nsd);
+    for (int i = 0; i < m_nn; i++) {
+        nodes[i] = m_nodes[m_oldNum[i]];
+        for (int j = 0; j < m_nsd; j++)
+            mass(i*m_nsd + j) = m_mass(m_oldNum[i]*m_nsd + j);
+    }
+    m_nodes.swap(nodes);
+    m_mass.swap(mass);
+
+    // stencils, renumbered and sorted together with their rest state
+    auto sortStencils = [this] (auto& stencils, std::vector<std::vector<double>*> restState) {
+        for (auto &istencil : stencils) {
+            for (int a = 0; a < istencil.size(); a++)
+                istencil[a] = m_newNum[istencil[a]];
+        }
+        std::vector<int> order(stencils.size());
+        for (int k = 0; k < order.size(); k++)
+            order[k] = k;
+        std::stable_sort(order.begin(), order.end(), [&stencils] (int a, int b) {
+            return stencils[a].minCoeff() < stencils[b].minCoeff();
+        });
+
+        auto sorted = stencils;
+        for (int k = 0; k < order.size(); k++)
+            sorted[k] = stencils[order[k]];
+        stencils.swap(sorted);
+        for (auto state : restState) {
+            std::vector<double> sortedState(state->size());
+            for (int k = 0; k < order.size(); k++)
+                sortedState[k] = (*state)[order[k]];
+            state->swap(sortedState);
+        }
+    };
+    sortStencils(m_edges, {&m_len0});
+    sortStencils(m_triangles, {&m_area, &m_phi0});
+    sortStencils(m_hinges, {&m_psi0, &m_const});
+}
+
 void Geometry::findMassVector() {
     m_mass = Eigen::VectorXd::Zero(m_nn * m_nsd);
 
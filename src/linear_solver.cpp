@@ -0,0 +1,119 @@
+#include "linear_solver.h"
+#include "pardiso_solver.h"
+#include "multigrid_solver.h"
+
+// create the backend of given type, see LinearSolverType
+LinearSolver* LinearSolver::create(const int type) {
+    switch (type) {
+        case CG_SOLVER:
+            return new JacobiCGSolver("Eigen CG");
+        case PARDISO_SOLVER:
+            return new PardisoSolver();
+        case LDLT_SOLVER:
+            return new LDLTSolver("Eigen LDLT");
+        case LLT_SOLVER:
+            return new LLTSolver("Eigen LLT");
+        case ICCG_SOLVER:
+            return new ICCGSolver("Eigen CG with incomplete Cholesky");
+        case MFCG_SOLVER:
+            return new MatrixFreeCGSolver();
+        case MGCG_SOLVER:
+            return new MultigridSolver(false);
+        case MG_SOLVER:
+            return new MultigridSolver(true);
+        default:
+            throw "unknown linear solver, check linear_solver in input.txt";
+    }
+}
+
+void LinearSolver::solveMatrixFree(const JacobianOperator& J, const VectorN& rhs, VectorN& u) {
+    (void) J; (void) rhs; (void) u;
+    throw "the linear solver requires an assembled jacobian";
+}
+
+// -----------------------------------------------------------------------
+
+// ordering and symbolic factorization in the first call, numerical factorization only afterwards
+template <typename Decomposition>
+void SimplicialSolver<Decomposition>::compute(const SpMatrix& A) {
+    if (!m_analyzed) {
+        m_solver.analyzePattern(A);
+        m_analyzed = true;
+    }
+    m_solver.factorize(A);
+    if (m_solver.info() != Eigen::Success)
+        throw "decomposition failed";
+}
+
+template <typename Decomposition>
+void SimplicialSolver<Decomposition>::solve(const VectorN& rhs, VectorN& u) {
+    u = m_solver.solve(rhs);
+    if (m_solver.info() != Eigen::Success)
+        throw "solving failed";
+}
+
+// -----------------------------------------------------------------------
+
+// the preconditioner is rebuilt for every matrix, its analysis is only done once
+template <typename Preconditioner>
+void CGSolver<Preconditioner>::compute(const SpMatrix& A) {
+    if (!m_analyzed) {
+        m_solver.analyzePattern(A);
+        m_analyzed = true;
+    }
+    m_solver.factorize(A);
+    if (m_solver.info() != Eigen::Success)
+        throw "decomposition failed";
+}
+
+// an inexact solve that hits the iteration limit is still a usable Newton direction
+template <typename Preconditioner>
+void CGSolver<Preconditioner>::solve(const VectorN& rhs, VectorN& u) {
+    u = m_solver.solve(rhs);
+    m_iterations += m_solver.iterations();
+    if (m_solver.info() == Eigen::NoConvergence && m_adaptive)
+        return;
+    if (m_solver.info() != Eigen::Success)
+        throw "solving failed";
+}
+
+template <typename Preconditioner>
+void CGSolver<Preconditioner>::setTolerance(const double tol) {
+    m_solver.setTolerance(tol);
+    m_adaptive = true;
+}
+
+// -----------------------------------------------------------------------
+
+void MatrixFreeCGSolver::compute(const SpMatrix& A) {
+    (void) A;
+    throw "matrix-free solver has no assembled jacobian, use solveMatrixFree()";
+}
+
+void MatrixFreeCGSolver::solve(const VectorN& rhs, VectorN& u) {
+    (void) rhs; (void) u;
+    throw "matrix-free solver has no assembled jacobian, use solveMatrixFree()";
+}
+
+void MatrixFreeCGSolver::setTolerance(const double tol) {
+    m_tol = tol;
+    m_adaptive = true;
+}
+
+// the Jacobi preconditioner is taken from the diagonal of the operator in every solve
+void MatrixFreeCGSolver::solveMatrixFree(const JacobianOperator& J, const VectorN& rhs, VectorN& u) {
+    Eigen::ConjugateGradient<JacobianOperator, Eigen::Lower|Eigen::Upper, JacobiPreconditioner> CGsolver;
+    CGsolver.setTolerance(m_tol);
+    CGsolver.compute(J);
+    u = CGsolver.solve(rhs);
+    m_iterations += CGsolver.iterations();
+    if (CGsolver.info() == Eigen::NoConvergence && m_adaptive)
+        return;
+    if (CGsolver.info() != Eigen::Success)
+        throw "solving failed";
+}
+
+template class SimplicialSolver<Eigen::SimplicialLDLT<SpMatrix, Eigen::Upper, Eigen::AMDOrdering<int> > >;
+template class SimplicialSolver<Eigen::SimplicialLLT<SpMatrix, Eigen::Upper, Eigen::AMDOrdering<int> > >;
+template class CGSolver<Eigen::DiagonalPreconditioner<double> >;
+template class CGSolver<Eigen::IncompleteCholesky<double, Eigen::Upper, Eigen::AMDOrdering<int> > >;
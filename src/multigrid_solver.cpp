@@ -0,0 +1,248 @@
+#include <iostream>
+#include <algorithm>
+
+#include "multigrid_solver.h"
+
+MultigridSolver::MultigridSolver(const bool standalone)
+    : m_standalone(standalone), m_tol(1e-10), m_adaptive(false), m_iterations(0), m_analyzed(false)
+{}
+
+const char* MultigridSolver::name() const {
+    return m_standalone ? "Geometric multigrid" : "Multigrid preconditioned CG";
+}
+
+void MultigridSolver::setTolerance(const double tol) {
+    m_tol = tol;
+    m_adaptive = true;
+}
+
+// build the grid hierarchy, it only depends on the mesh and the boundary conditions
+//   gridDofs: grid dof of each free dof of the jacobian
+void MultigridSolver::setGrid(const int nlen, const int nwid, const std::vector<int>& gridDofs) {
+    const int MIN_COARSE = 1000;    // dofs of the coarsest level, solved by LDLT
+    const int MIN_LINES = 5;        // grid lines in each direction that can still be coarsened
+
+    m_levels.clear();
+    m_levels.emplace_back();
+    m_levels[0].nlen = nlen;
+    m_levels[0].nwid = nwid;
+    m_levels[0].gridDofs = gridDofs;
+    findBlocks(m_levels[0]);
+
+    while (m_levels.back().gridDofs.size() > MIN_COARSE &&
+           m_levels.back().nlen >= MIN_LINES && m_levels.back().nwid >= MIN_LINES) {
+        Level coarse;
+        coarsen(m_levels.back(), coarse);
+        findBlocks(coarse);
+        m_levels.push_back(coarse);
+    }
+    m_analyzed = false;
+
+    std::cout << "multigrid levels:";
+    for (auto &level : m_levels)
+        std::cout << ' ' << level.nlen << 'x' << level.nwid;
+    std::cout << ", coarsest level " << m_levels.back().gridDofs.size() << " dofs" << std::endl;
+}
+
+// Galerkin operators of all levels, factorization of the coarsest one
+void MultigridSolver::compute(const SpMatrix& A) {
+    if (m_levels.empty())
+        throw "multigrid solver requires the structured grid, call setGrid() first";
+
+    m_levels[0].A = A.selfadjointView<Eigen::Upper>();
+    for (int l = 0; l+1 < m_levels.size(); l++) {
+        SpMatrix AP = m_levels[l].A * m_levels[l].P;
+        m_levels[l+1].A = m_levels[l].R * AP;
+        findInvDiag(m_levels[l]);
+    }
+
+    // the pattern of the coarsest operator is fixed, its analysis is only done once
+    Eigen::SparseMatrix<double> coarseA = m_levels.back().A;
+    if (!m_analyzed) {
+        m_coarseSolver.analyzePattern(coarseA);
+        m_analyzed = true;
+    }
+    m_coarseSolver.factorize(coarseA);
+    if (m_coarseSolver.info() != Eigen::Success)
+        throw "decomposition failed";
+}
+
+void MultigridSolver::solve(const VectorN& rhs, VectorN& u) {
+    const int MAX_ITER = 500;
+    const SpMatrix& A = m_levels[0].A;
+
+    u = VectorN::Zero(rhs.size());
+    double rhs_norm = rhs.norm();
+    if (rhs_norm == 0.0)
+        return;
+
+    VectorN r = rhs;
+    if (m_standalone) {
+        // V-cycles, each one improves the current solution
+        for (int iter = 0; iter < MAX_ITER; iter++) {
+            vcycle(0, rhs, u);
+            m_iterations++;
+            r = rhs - A * u;
+            if (r.norm() <= m_tol * rhs_norm)
+                return;
+        }
+    }
+    else {
+        // conjugate gradient, preconditioned by one V-cycle from zero
+        VectorN z = VectorN::Zero(rhs.size());
+        vcycle(0, r, z);
+        VectorN p = z;
+        double rz = r.dot(z);
+        for (int iter = 0; iter < MAX_ITER; iter++) {
+            VectorN Ap = A * p;
+            double alpha = rz / p.dot(Ap);
+            u += alpha * p;
+            r -= alpha * Ap;
+            m_iterations++;
+            if (r.norm() <= m_tol * rhs_norm)
+                return;
+
+            z.setZero();
+            vcycle(0, r, z);
+            double rz_new = r.dot(z);
+            p = z + (rz_new / rz) * p;
+            rz = rz_new;
+        }
+    }
+
+    // an inexact solve that hits the iteration limit is still a usable Newton direction
+    if (!m_adaptive)
+        throw "solving failed";
+}
+
+// coarse grid: even grid lines of the fine grid and its last line
+// fine dofs are interpolated bilinearly from the dofs of the surrounding coarse nodes
+void MultigridSolver::coarsen(Level& fine, Level& coarse) {
+    auto coarseLines = [] (const int n, std::vector<int>& fineToCoarse) {
+        fineToCoarse.assign(n, -1);
+        int nc = 0;
+        for (int k = 0; k < n; k++) {
+            if (k % 2 == 0 || k == n-1)
+                fineToCoarse[k] = nc++;
+        }
+        return nc;
+    };
+    // coarse lines and weights of fine line k
+    auto interpolate = [] (const int k, const std::vector<int>& fineToCoarse, int* c, double* w) {
+        if (fineToCoarse[k] != -1) {
+            c[0] = fineToCoarse[k];
+            w[0] = 1.0;
+            return 1;
+        }
+        c[0] = fineToCoarse[k-1];
+        c[1] = fineToCoarse[k+1];
+        w[0] = w[1] = 0.5;
+        return 2;
+    };
+
+    std::vector<int> lenToCoarse, widToCoarse;
+    coarse.nlen = coarseLines(fine.nlen, lenToCoarse);
+    coarse.nwid = coarseLines(fine.nwid, widToCoarse);
+
+    SparseEntries entries;
+    for (int d = 0; d < fine.gridDofs.size(); d++) {
+        int node = fine.gridDofs[d] / 3;
+        int dir  = fine.gridDofs[d] % 3;
+        int ci[2], cj[2];
+        double wi[2], wj[2];
+        int ni = interpolate(node / fine.nlen, widToCoarse, ci, wi);
+        int nj = interpolate(node % fine.nlen, lenToCoarse, cj, wj);
+        for (int a = 0; a < ni; a++) {
+            for (int b = 0; b < nj; b++)
+                entries.emplace_back(d, 3 * (ci[a] * coarse.nlen + cj[b]) + dir, wi[a] * wj[b]);
+        }
+    }
+
+    // coarse dofs are the grid dofs that receive a weight, numbered by grid dof
+    std::vector<int> gridToCoarse(3 * coarse.nlen * coarse.nwid, -1);
+    for (auto &entry : entries)
+        gridToCoarse[entry.col()] = 0;
+    coarse.gridDofs.clear();
+    for (int g = 0; g < gridToCoarse.size(); g++) {
+        if (gridToCoarse[g] != -1) {
+            gridToCoarse[g] = (int) coarse.gridDofs.size();
+            coarse.gridDofs.push_back(g);
+        }
+    }
+    for (auto &entry : entries)
+        entry = Eigen::Triplet<double>(entry.row(), gridToCoarse[entry.col()], entry.value());
+
+    fine.P.resize(fine.gridDofs.size(), coarse.gridDofs.size());
+    fine.P.setFromTriplets(entries.begin(), entries.end());
+    fine.R = fine.P.transpose();
+}
+
+// dofs of the same grid node are numbered consecutively
+void MultigridSolver::findBlocks(Level& level) {
+    level.blockPtr.clear();
+    for (int d = 0; d < level.gridDofs.size(); d++) {
+        if (d == 0 || level.gridDofs[d] / 3 != level.gridDofs[d-1] / 3)
+            level.blockPtr.push_back(d);
+    }
+    level.blockPtr.push_back((int) level.gridDofs.size());
+}
+
+// blocks of less than 3 dofs are padded with the identity
+void MultigridSolver::findInvDiag(Level& level) {
+    int nblock = (int) level.blockPtr.size() - 1;
+    level.invDiag.resize(nblock);
+    for (int b = 0; b < nblock; b++) {
+        int first = level.blockPtr[b];
+        int n = level.blockPtr[b+1] - first;
+        Eigen::Matrix3d D = Eigen::Matrix3d::Identity();
+        for (int p = 0; p < n; p++) {
+            for (int q = 0; q < n; q++)
+                D(p,q) = level.A.coeff(first+p, first+q);
+        }
+        level.invDiag[b] = D.inverse();
+    }
+}
+
+// one sweep of block Gauss-Seidel, backward sweeps make the V-cycle symmetric
+void MultigridSolver::smooth(const Level& level, const VectorN& b, VectorN& x, const bool forward) const {
+    int nblock = (int) level.blockPtr.size() - 1;
+    for (int s = 0; s < nblock; s++) {
+        int blk = forward ? s : nblock-1-s;
+        int first = level.blockPtr[blk];
+        int n = level.blockPtr[blk+1] - first;
+
+        Eigen::Vector3d r = Eigen::Vector3d::Zero();
+        for (int p = 0; p < n; p++) {
+            double sum = b(first+p);
+            for (SpMatrix::InnerIterator it(level.A, first+p); it; ++it)
+                sum -= it.value() * x(it.col());
+            r(p) = sum;
+        }
+        Eigen::Vector3d dx = level.invDiag[blk] * r;
+        for (int p = 0; p < n; p++)
+            x(first+p) += dx(p);
+    }
+}
+
+// V-cycle on level l, x is the initial guess
+void MultigridSolver::vcycle(const int l, const VectorN& b, VectorN& x) {
+    const int NU = 2;               // pre- and post-smoothing sweeps
+    Level& level = m_levels[l];
+
+    if (l == m_levels.size()-1) {
+        x = m_coarseSolver.solve(b);
+        return;
+    }
+
+    for (int s = 0; s < NU; s++)
+        smooth(level, b, x, true);
+
+    VectorN r = b - level.A * x;
+    VectorN bc = level.R * r;
+    VectorN xc = VectorN::Zero(bc.size());
+    vcycle(l+1, bc, xc);
+    x += level.P * xc;
+
+    for (int s = 0; s < NU; s++)
+        smooth(level, b, x, false);
+}
@@ -6,6 +6,32 @@
 Parameters::Parameters(const std::string& t_input, const std::string& t_output) {
     m_inputPath = t_input;
     m_outputPath = t_output;
+
+    // default values of optional parameters
+    assemble_op_ = 0;
+    linear_solver_ = 1;
+    newton_op_ = 0;
+    refactor_ratio_ = 0.5;
+    inexact_newton_ = 0;
+    forcing_max_ = 0.9;
+    reorder_op_ = 0;
+    adaptive_dt_ = 0;
+    dt_min_ = 1e-6;
+    dt_max_ = 1e-1;
+    integrator_ = 0;
+    rho_inf_ = 0.8;
+    pd_iter_ = 10;
+    relax_op_ = 0;
+    relax_iter_ = 100000;
+    predictor_ = 0;
+    checkpoint_freq_ = 0;
+    restart_ = false;
+    out_format_ = 0;
+    async_output_ = 0;
+    out_buffer_ = 4;
+    out_keyframe_ = 100;
+    out_error_ = 1e-6;
+    out_fields_ = 0;
 }
 
 // destructor
@@ -27,6 +53,30 @@ void Parameters::set_rho(const double var)                  { rho_ = var; }
 void Parameters::set_thk(const double var)                  { thk_ = var; }
 void Parameters::set_vis(const double var)                  { vis_ = var; }
 void Parameters::set_gconst(const double var)               { gconst_ = var; }
+void Parameters::set_assemble_op(const int var)             { assemble_op_ = var; }
+void Parameters::set_linear_solver(const int var)           { linear_solver_ = var; }
+void Parameters::set_newton_op(const int var)               { newton_op_ = var; }
+void Parameters::set_refactor_ratio(const double var)       { refactor_ratio_ = var; }
+void Parameters::set_inexact_newton(const int var)          { inexact_newton_ = var; }
+void Parameters::set_forcing_max(const double var)          { forcing_max_ = var; }
+void Parameters::set_reorder_op(const int var)              { reorder_op_ = var; }
+void Parameters::set_adaptive_dt(const int var)             { adaptive_dt_ = var; }
+void Parameters::set_dt_min(const double var)               { dt_min_ = var; }
+void Parameters::set_dt_max(const double var)               { dt_max_ = var; }
+void Parameters::set_integrator(const int var)              { integrator_ = var; }
+void Parameters::set_rho_inf(const double var)              { rho_inf_ = var; }
+void Parameters::set_pd_iter(const int var)                 { pd_iter_ = var; }
+void Parameters::set_relax_op(const int var)                { relax_op_ = var; }
+void Parameters::set_relax_iter(const int var)              { relax_iter_ = var; }
+void Parameters::set_predictor(const int var)               { predictor_ = var; }
+void Parameters::set_checkpoint_freq(const int var)         { checkpoint_freq_ = var; }
+void Parameters::set_restart(const bool var)                { restart_ = var; }
+void Parameters::set_out_format(const int var)              { out_format_ = var; }
+void Parameters::set_async_output(const int var)            { async_output_ = var; }
+void Parameters::set_out_buffer(const int var)              { out_buffer_ = var; }
+void Parameters::set_out_keyframe(const int var)            { out_keyframe_ = var; }
+void Parameters::set_out_error(const double var)            { out_error_ = var; }
+void Parameters::set_out_fields(const int var)              { out_fields_ = var; }
 void Parameters::set_kstretch()                             { ks_ = E_modulus_ * thk_; }
 void Parameters::set_kstretch(const double var)             { ks_ = var; }
 void Parameters::set_kshear()                               { ksh_ = E_modulus_ * thk_; }
@@ -50,6 +100,30 @@ double        Parameters::rho() const           { return rho_; }
 double        Parameters::thk() const           { return thk_; }
 double        Parameters::vis() const           { return vis_; }
 double        Parameters::gconst() const        { return gconst_; }
+int           Parameters::assemble_op() const   { return assemble_op_; }
+int           Parameters::linear_solver() const { return linear_solver_; }
+int           Parameters::newton_op() const     { return newton_op_; }
+double        Parameters::refactor_ratio() const { return refactor_ratio_; }
+int           Parameters::inexact_newton() const { return inexact_newton_; }
+double        Parameters::forcing_max() const   { return forcing_max_; }
+int           Parameters::reorder_op() const    { return reorder_op_; }
+int           Parameters::adaptive_dt() const   { return adaptive_dt_; }
+double        Parameters::dt_min() const        { return dt_min_; }
+double        Parameters::dt_max() const        { return dt_max_; }
+int           Parameters::integrator() const    { return integrator_; }
+double        Parameters::rho_inf() const       { return rho_inf_; }
+int           Parameters::pd_iter() const       { return pd_iter_; }
+int           Parameters::relax_op() const      { return relax_op_; }
+int           Parameters::relax_iter() const    { return relax_iter_; }
+int           Parameters::predictor() const     { return predictor_; }
+int           Parameters::checkpoint_freq() const { return checkpoint_freq_; }
+bool          Parameters::restart() const         { return restart_; }
+int           Parameters::out_format() const    { return out_format_; }
+int           Parameters::async_output() const  { return async_output_; }
+int           Parameters::out_buffer() const    { return out_buffer_; }
+int           Parameters::out_keyframe() const  { return out_keyframe_; }
+double        Parameters::out_error() const     { return out_error_; }
+int           Parameters::out_fields() const    { return out_fields_; }
 double        Parameters::kstretch() const      { return ks_; }
 double        Parameters::kshear() const        { return ksh_; }
 double        Parameters::kbend() const         { return kb_; }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+
+#include "pardiso_solver.h"
+
+PardisoSolver::PardisoSolver()
+    : m_mtype(-2), m_maxfct(1), m_mnum(1), m_msglvl(0), m_nrhs(1), m_n(0), m_analyzed(false), m_a(nullptr)
+{
+    /* -------------------------------------------------------------------- */
+    /* ..  Setup Pardiso control parameters.                                */
+    /* -------------------------------------------------------------------- */
+    int error = 0;
+    int solver = 0;         /* use sparse direct solver */
+    pardisoinit(m_pt, &m_mtype, &solver, m_iparm, m_dparm, &error);
+
+    if (error != 0) {
+        if (error == -10)
+            std::cerr << "No license file found" << std::endl;
+        if (error == -11)
+            std::cerr << "License is expired" << std::endl;
+        if (error == -12)
+            std::cerr << "Wrong username or hostname" << std::endl;
+        throw "Pardiso initialization failed";
+    }
+
+    /* Numbers of processors, value of OMP_NUM_THREADS */
+    char* var = getenv("OMP_NUM_THREADS");
+    int num_procs = 0;
+    if (var != NULL)
+        sscanf(var, "%d", &num_procs);
+    else
+        throw "Set environment OMP_NUM_THREADS to 1";
+    m_iparm[2] = num_procs;
+
+    m_iparm[32] = 1;        /* compute determinant */
+    m_iparm[7] = 1;         /* Max numbers of iterative refinement steps. */
+}
+
+PardisoSolver::~PardisoSolver() {
+    /* -------------------------------------------------------------------- */
+    /* ..  Termination and release of memory.                               */
+    /* -------------------------------------------------------------------- */
+    if (m_analyzed) {
+        double ddum;
+        m_a = &ddum;
+        try {
+            call(-1, &ddum, &ddum);
+        }
+        catch (const char* msg) {
+            std::cerr << msg << std::endl;
+        }
+    }
+}
+
+// numerical factorization, the first call also does reordering and symbolic factorization
+void PardisoSolver::compute(const SpMatrix& A) {
+    if (!A.isCompressed())
+        throw "Pardiso solver requires a compressed matrix";
+
+    if (!m_analyzed)
+        analyze(A);
+    else if (A.rows() != m_n || A.nonZeros() != m_ja.size())
+        throw "sparsity pattern of the matrix changed";
+
+    /* -------------------------------------------------------------------- */
+    /* ..  Numerical factorization.                                         */
+    /* -------------------------------------------------------------------- */
+    m_a = const_cast<double*>(A.valuePtr());
+    double ddum;
+    call(22, &ddum, &ddum);
+}
+
+// back substitution and iterative refinement
+void PardisoSolver::solve(const VectorN& rhs, VectorN& u) {
+    if (!m_analyzed)
+        throw "compute() must be called before solve()";
+
+    u.resize(m_n);
+    call(33, const_cast<double*>(rhs.data()), u.data());
+}
+
+// reordering and symbolic factorization, this also allocates all memory of the factorization
+void PardisoSolver::analyze(const SpMatrix& A) {
+    m_n = A.rows();
+    int nonzeros = A.nonZeros();
+
+    // Convert matrix from 0-based C-notation to Fortran 1-based notation
+    m_ia.resize(m_n+1);
+    m_ja.resize(nonzeros);
+    for (int i = 0; i < m_n+1; i++)
+        m_ia[i] = A.outerIndexPtr()[i] + 1;
+    for (int i = 0; i < nonzeros; i++)
+        m_ja[i] = A.innerIndexPtr()[i] + 1;
+
+    m_a = const_cast<double*>(A.valuePtr());
+    double ddum;
+    call(11, &ddum, &ddum);
+    m_analyzed = true;
+}
+
+void PardisoSolver::call(int phase, double* b, double* x) {
+    int idum;               /* Integer dummy. */
+    int error = 0;
+
+    pardiso(m_pt, &m_maxfct, &m_mnum, &m_mtype, &phase,
+            &m_n, m_a, m_ia.data(), m_ja.data(), &idum, &m_nrhs,
+            m_iparm, &m_msglvl, b, x, &error, m_dparm);
+
+    if (error != 0) {
+        std::cerr << "Pardiso error " << error << " in phase " << phase << std::endl;
+        if (phase == 11)
+            throw "ERROR during symbolic factorization";
+        else if (phase == 22)
+            throw "ERROR during numerical factorization";
+        else if (phase == 33)
+            throw "ERROR during solution";
+        else
+            throw "ERROR during release of memory";
+    }
+}
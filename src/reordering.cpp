@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+#include "reordering.h"
+
+// ========================================= //
+//      Declaration of helper functions      //
+// ========================================= //
+
+static std::vector<int> levelStructure(const NodeGraph& graph, const int root, const std::vector<int>& part,
+                                       const int label, std::vector<int>& level);
+static int pseudoPeripheralNode(const NodeGraph& graph, const int start, const std::vector<int>& part,
+                                const int label, std::vector<int>& level);
+static void dissect(const NodeGraph& graph, const std::vector<int>& nodes, const int label, std::vector<int>& part,
+                    std::vector<int>& level, int& nextLabel, std::vector<int>& order);
+
+
+// ========================================= //
+//             Node orderings                //
+// ========================================= //
+
+// all pairs of nodes of the edges and hinges
+NodeGraph buildNodeGraph(const int nn, const VectorEdges& edges, const VectorHinges& hinges) {
+    std::vector<std::vector<int> > neighbors(nn);
+    for (auto &iedge : edges) {
+        neighbors[iedge[0]].push_back(iedge[1]);
+        neighbors[iedge[1]].push_back(iedge[0]);
+    }
+    for (auto &ihinge : hinges) {
+        for (int a = 0; a < 4; a++) {
+            for (int b = 0; b < 4; b++) {
+                if (a != b)
+                    neighbors[ihinge[a]].push_back(ihinge[b]);
+            }
+        }
+    }
+
+    NodeGraph graph;
+    graph.xadj.resize(nn+1);
+    graph.xadj[0] = 0;
+    for (int i = 0; i < nn; i++) {
+        std::sort(neighbors[i].begin(), neighbors[i].end());
+        auto last = std::unique(neighbors[i].begin(), neighbors[i].end());
+        graph.adj.insert(graph.adj.end(), neighbors[i].begin(), last);
+        graph.xadj[i+1] = (int) graph.adj.size();
+    }
+    return graph;
+}
+
+// Cuthill-McKee from a pseudo-peripheral node of every connected component, neighbors are
+// visited by increasing degree, and the whole ordering is reversed
+std::vector<int> rcmOrdering(const NodeGraph& graph) {
+    int nn = graph.nn();
+    std::vector<int> part(nn, 0);
+    std::vector<int> level(nn, -1);
+    std::vector<bool> visited(nn, false);
+    std::vector<int> order;
+    order.reserve(nn);
+
+    std::vector<int> next;
+    for (int start = 0; start < nn; start++) {
+        if (visited[start])
+            continue;
+
+        int root = pseudoPeripheralNode(graph, start, part, 0, level);
+        int head = (int) order.size();
+        order.push_back(root);
+        visited[root] = true;
+        while (head < order.size()) {
+            int i = order[head++];
+            next.clear();
+            for (int p = graph.xadj[i]; p < graph.xadj[i+1]; p++) {
+                int j = graph.adj[p];
+                if (!visited[j]) {
+                    visited[j] = true;
+                    next.push_back(j);
+                }
+            }
+            std::stable_sort(next.begin(), next.end(), [&graph] (int a, int b) {
+                return graph.degree(a) < graph.degree(b);
+            });
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// recursive bisection by the middle level of a breadth-first search, separators are numbered last
+std::vector<int> nestedDissectionOrdering(const NodeGraph& graph) {
+    int nn = graph.nn();
+    std::vector<int> part(nn, 0);
+    std::vector<int> level(nn, -1);
+    std::vector<int> order;
+    order.reserve(nn);
+
+    std::vector<int> nodes(nn);
+    std::iota(nodes.begin(), nodes.end(), 0);
+    int nextLabel = 1;
+    dissect(graph, nodes, 0, part, level, nextLabel, order);
+    return order;
+}
+
+int bandwidth(const NodeGraph& graph, const std::vector<int>& newNum) {
+    int bw = 0;
+    for (int i = 0; i < graph.nn(); i++) {
+        for (int p = graph.xadj[i]; p < graph.xadj[i+1]; p++)
+            bw = std::max(bw, std::abs(newNum[i] - newNum[graph.adj[p]]));
+    }
+    return bw;
+}
+
+// ========================================= //
+//     Implementation of helper functions    //
+// ========================================= //
+
+// breadth-first search from root inside the nodes with part[i] == label
+// returns the nodes in visiting order, level[i] is the distance to root
+// NOTE: level has to be -1 for all nodes of the part, the caller resets the visited nodes
+static std::vector<int> levelStructure(const NodeGraph& graph, const int root, const std::vector<int>& part,
+                                       const int label, std::vector<int>& level) {
+    std::vector<int> visit;
+    visit.push_back(root);
+    level[root] = 0;
+    for (int head = 0; head < visit.size(); head++) {
+        int i = visit[head];
+        for (int p = graph.xadj[i]; p < graph.xadj[i+1]; p++) {
+            int j = graph.adj[p];
+            if (part[j] == label && level[j] == -1) {
+                level[j] = level[i] + 1;
+                visit.push_back(j);
+            }
+        }
+    }
+    return visit;
+}
+
+// George-Liu: restart from the node of smallest degree in the last level while the depth grows
+static int pseudoPeripheralNode(const NodeGraph& graph, const int start, const std::vector<int>& part,
+                                const int label, std::vector<int>& level) {
+    int root = start;
+    int depth = -1;
+    while (true) {
+        std::vector<int> visit = levelStructure(graph, root, part, label, level);
+        int newDepth = level[visit.back()];
+        int candidate = visit.back();
+        for (int k = (int) visit.size()-1; k >= 0 && level[visit[k]] == newDepth; k--) {
+            if (graph.degree(visit[k]) < graph.degree(candidate))
+                candidate = visit[k];
+        }
+        for (int i : visit)
+            level[i] = -1;
+
+        if (newDepth <= depth)
+            return root;
+        depth = newDepth;
+        root = candidate;
+    }
+}
+
+// order the nodes of part label: both halves first, then the separator
+static void dissect(const NodeGraph& graph, const std::vector<int>& nodes, const int label, std::vector<int>& part,
+                    std::vector<int>& level, int& nextLabel, std::vector<int>& order) {
+    const int MIN_SIZE = 64;        // small parts are not dissected any further
+    if (nodes.size() <= MIN_SIZE) {
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+
+    int root = pseudoPeripheralNode(graph, nodes[0], part, label, level);
+    std::vector<int> visit = levelStructure(graph, root, part, label, level);
+
+    // disconnected part, the component of root and the rest are dissected separately
+    if (visit.size() < nodes.size()) {
+        std::vector<int> rest;
+        for (int i : nodes) {
+            if (level[i] == -1)
+                rest.push_back(i);
+        }
+        int labelA = nextLabel++;
+        int labelB = nextLabel++;
+        for (int i : visit) {
+            level[i] = -1;
+            part[i] = labelA;
+        }
+        for (int i : rest)
+            part[i] = labelB;
+        dissect(graph, visit, labelA, part, level, nextLabel, order);
+        dissect(graph, rest, labelB, part, level, nextLabel, order);
+        return;
+    }
+
+    int depth = level[visit.back()];
+    if (depth < 2) {
+        for (int i : visit)
+            level[i] = -1;
+        order.insert(order.end(), nodes.begin(), nodes.end());
+        return;
+    }
+
+    // separator: the level that splits the nodes in halves, it is never the first or the last level
+    std::vector<int> levelSize(depth+1, 0);
+    for (int i : visit)
+        levelSize[level[i]]++;
+    int sep = 1;
+    int count = levelSize[0] + levelSize[1];
+    while (sep < depth-1 && 2 * count < (int) visit.size())
+        count += levelSize[++sep];
+
+    std::vector<int> nodesA, nodesB, separator;
+    for (int i : visit) {
+        if (level[i] < sep)
+            nodesA.push_back(i);
+        else if (level[i] > sep)
+            nodesB.push_back(i);
+        else
+            separator.push_back(i);
+    }
+    for (int i : visit)
+        level[i] = -1;
+
+    int labelA = nextLabel++;
+    int labelB = nextLabel++;
+    for (int i : nodesA)
+        part[i] = labelA;
+    for (int i : nodesB)
+        part[i] = labelB;
+    for (int i : separator)
+        part[i] = -1;
+
+    dissect(graph, nodesA, labelA, part, level, nextLabel, order);
+    dissect(graph, nodesB, labelB, part, level, nextLabel, order);
+    order.insert(order.end(), separator.begin(), separator.end());
+}
@@ -17,26 +17,23 @@ Simulation::Simulation(const std::string& t_input, const std::string& t_output)
     m_SolverImpl = new SolverImpl(m_SimPar, m_SimGeo, m_SimBC);
 }
 
+// the solver goes first, its output writer thread may still use the geometry
 Simulation::~Simulation() {
+    delete m_SolverImpl;
+    delete m_PreProcessor;
     delete m_SimPar;
     delete m_SimGeo;
     delete m_SimBC;
-    delete m_PreProcessor;
-    delete m_SolverImpl;
 }
 
 void Simulation::pre_process(const Arguments& t_args) {
     m_PreProcessor->PreProcess(t_args);
+    m_SimPar->set_restart(t_args.restart);
     m_SimBC->initBC();
     m_SolverImpl->initSolver();
 }
 
 void Simulation::solve() {
-    if (SOLVER_TYPE == 0)
-        std::cout << "Eigen CG solver will be used" << std::endl;
-    else if (SOLVER_TYPE == 1)
-        std::cout << "Pardiso solver will be used" << std::endl;
-
     // timer for entire simulation
     Timer t_all(true);
     
@@ -44,6 +41,10 @@ void Simulation::solve() {
         std::cout << "Dynamic simulation starts\n" << std::endl;
         m_SolverImpl->dynamic();
     }
+    else if (m_SimPar->relax_op() == 1) {
+        std::cout << "Static relaxation starts\n" << std::endl;
+        m_SolverImpl->relaxation();
+    }
     else {
         std::cout << "Static simulation starts\n" << std::endl;
         m_SolverImpl->statics();
@@ -2,6 +2,8 @@
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <array>
+#include <map>
 #include <algorithm>
 #include <cassert>
 #include <cstdio>
@@ -12,34 +14,195 @@
 #include "parameters.h"
 #include "geometry.h"
 #include "loadbc.h"
-#include "node.h"
-#include "hinge.h"
-#include "edge.h"
-#include "element.h"
 #include "utilities.h"
 #include "stretching.h"
 #include "shearing.h"
 #include "bending.h"
+#include "linear_solver.h"
+#include "jacobian_operator.h"
+#include "trajectory_writer.h"
+#include "async_writer.h"
+#include "compressed_writer.h"
+#include "xdmf_writer.h"
+#include "checkpoint.h"
 
 
 SolverImpl::SolverImpl(Parameters* SimPar, Geometry* SimGeo, Boundary* SimBC) {
     m_SimPar = SimPar;
     m_SimGeo = SimGeo;
     m_SimBC  = SimBC;
+    m_linearSolver = nullptr;
+    m_trajectory = nullptr;
+    m_writer = nullptr;
+    m_compressed = nullptr;
+    m_xdmf = nullptr;
+    m_checkpoint = nullptr;
+}
+
+// the writer thread is stopped before the trajectory file is closed
+SolverImpl::~SolverImpl() {
+    delete m_writer;
+    delete m_linearSolver;
+    delete m_trajectory;
+    delete m_compressed;
+    delete m_xdmf;
+    delete m_checkpoint;
 }
 
 void SolverImpl::initSolver() {
     DYNAMIC_SOLVER = m_SimPar->solver_op();
     WRITE_OUTPUT = m_SimPar->outop();
+    PARALLEL_ASSEMBLY = (m_SimPar->assemble_op() == 1);
+    MODIFIED_NEWTON = (m_SimPar->newton_op() == 1);
 
     m_numTotal = m_SimGeo->nn() * m_SimGeo->nsd();
     m_numDirichlet = (int) m_SimBC->m_dirichletDofs.size();
     m_numNeumann = m_numTotal - m_numDirichlet;
     
+    // a restart reads the checkpoint before the output files are continued
+    delete m_checkpoint;
+    m_checkpoint = nullptr;
+    long resume = 0;
+    if (m_SimPar->checkpoint_freq() > 0 || m_SimPar->restart())
+        m_checkpoint = new Checkpoint(m_SimPar->outputPath() + "checkpoint.bin", findStateHash());
+    if (m_SimPar->restart()) {
+        if (!DYNAMIC_SOLVER && m_SimPar->relax_op() == 1)
+            throw "FIRE relaxation has no checkpoints";
+        m_checkpoint->load();
+        m_checkpoint->get(resume);
+    }
+
+    // all frames go into one binary file instead of a text file per frame
+    delete m_writer;
+    m_writer = nullptr;
+    delete m_trajectory;
+    delete m_compressed;
+    delete m_xdmf;
+    m_trajectory = nullptr;
+    m_compressed = nullptr;
+    m_xdmf = nullptr;
+    if (m_SimPar->out_format() < 0 || m_SimPar->out_format() > 5)
+        throw "out_format must be between 0 and 5";
+    if (m_SimPar->out_fields() != 0 && m_SimPar->out_format() < 4)
+        throw "out_fields requires the XDMF export, out_format 4 or 5";
+    if (WRITE_OUTPUT && (m_SimPar->out_format() == 1 || m_SimPar->out_format() == 2))
+        m_trajectory = new TrajectoryWriter(m_SimPar->outputPath() + "trajectory.bin", m_SimGeo,
+                                            m_SimPar->out_format() == 2, resume);
+    if (WRITE_OUTPUT && m_SimPar->out_format() == 3)
+        m_compressed = new CompressedWriter(m_SimPar->outputPath() + "trajectory.psz", m_SimGeo,
+                                            m_SimPar->out_keyframe(), m_SimPar->out_error(), resume);
+    if (WRITE_OUTPUT && m_SimPar->out_format() >= 4) {
+        m_xdmf = new XdmfWriter(m_SimPar->outputPath(), m_SimGeo, m_SimPar->out_format() == 5,
+                                m_SimPar->out_fields(), resume);
+        findOutputMaps();
+    }
+
+    // frames are serialized by a writer thread, the solver only copies the nodal positions and fields
+    if (m_SimPar->async_output() < 0 || m_SimPar->async_output() > 2)
+        throw "async_output must be 0, 1 or 2";
+    if (WRITE_OUTPUT && m_SimPar->async_output() > 0) {
+        bool drop = (m_SimPar->async_output() == 2);
+        m_writer = new AsyncWriter(m_SimPar->out_buffer(), m_SimGeo->nn(), drop,
+                                   [this] (const int ist, const double time, const VectorNodes& nodes, const VectorN& fields) {
+                                       writeFrame(ist, time, nodes, fields);
+                                   });
+        std::cout << "background output writer, " << m_SimPar->out_buffer() << " frames buffered, "
+                  << (drop ? "frames are dropped" : "the solver waits") << " if the buffer is full" << std::endl;
+    }
+
     m_tol = m_SimGeo->m_mi * m_SimPar->gconst() * m_SimPar->ctol();
     m_incRatio = 1.0 / ((double) m_SimPar->nst());
 
+    // the explicit integrator only needs the gradient, there is no linear solver
+    EXPLICIT = DYNAMIC_SOLVER && (m_SimPar->integrator() == 2);
+    // projective dynamics factorizes its constant system matrix once
+    PROJECTIVE = DYNAMIC_SOLVER && (m_SimPar->integrator() == 3);
+    // FIRE relaxation replaces the Newton load increments of the static solver
+    RELAXATION = !DYNAMIC_SOLVER && (m_SimPar->relax_op() == 1);
+    GRADIENT_ONLY = EXPLICIT || RELAXATION;
+
+    // the jacobian pattern is fixed, the solver reuses its analysis for all solves
+    delete m_linearSolver;
+    m_linearSolver = nullptr;
+    MATRIX_FREE = false;
+    if (!GRADIENT_ONLY) {
+        m_linearSolver = LinearSolver::create(m_SimPar->linear_solver());
+        if (PROJECTIVE && (m_linearSolver->iterative() || m_linearSolver->matrixFree())) {
+            delete m_linearSolver;
+            m_linearSolver = LinearSolver::create(LDLT_SOLVER);
+        }
+        std::cout << m_linearSolver->name() << " solver will be used" << std::endl;
+        MATRIX_FREE = m_linearSolver->matrixFree();
+    }
+
     findMappingVectors();
+    if (!GRADIENT_ONLY)
+        findGrid();
+    if (!MATRIX_FREE && !GRADIENT_ONLY && !PROJECTIVE)
+        findSparsityPattern();
+    findColoring();
+    findMaterialState();
+
+    m_factorized = false;
+    m_numIterations = 0;
+    m_numFactorizations = 0;
+    m_numSteps = 0;
+    if (MODIFIED_NEWTON)
+        std::cout << "modified Newton, refactor ratio " << m_SimPar->refactor_ratio() << std::endl;
+
+    // gradient-only methods have no Newton iterations and no linear solver
+    INEXACT_NEWTON = false;
+    if (m_SimPar->inexact_newton() == 1 && !GRADIENT_ONLY) {
+        if (m_linearSolver->iterative()) {
+            INEXACT_NEWTON = true;
+            std::cout << "inexact Newton, maximum forcing term " << m_SimPar->forcing_max() << std::endl;
+        }
+        else
+            std::cout << "inexact Newton is ignored, it requires an iterative linear solver" << std::endl;
+    }
+    m_forcing = m_SimPar->forcing_max();
+
+    m_numHistory = 0;
+    m_dtPrev = m_SimPar->dt();
+    if (m_SimPar->predictor() < 0 || m_SimPar->predictor() > 2)
+        throw "predictor must be 0, 1 or 2";
+    if (m_SimPar->predictor() > 0 && !GRADIENT_ONLY && !PROJECTIVE)
+        std::cout << (m_SimPar->predictor() == 1 ? "linear" : "quadratic") << " predictor of the Newton initial guess" << std::endl;
+
+    m_dt = m_SimPar->dt();
+    ADAPTIVE_STEP = DYNAMIC_SOLVER && !EXPLICIT && !PROJECTIVE && (m_SimPar->adaptive_dt() == 1);
+    if (ADAPTIVE_STEP)
+        std::cout << "adaptive step size between " << m_SimPar->dt_min()
+                  << " and " << m_SimPar->dt_max() << std::endl;
+
+    // generalized-alpha parameters of Chung and Hulbert, second order accurate and
+    // unconditionally stable, rho_inf = 1 is the trapezoidal rule without dissipation
+    GEN_ALPHA = DYNAMIC_SOLVER && (m_SimPar->integrator() == 1);
+    if (GEN_ALPHA) {
+        double rho = m_SimPar->rho_inf();
+        if (rho < 0.0 || rho > 1.0)
+            throw "rho_inf of generalized-alpha must be in [0, 1]";
+        m_alphaM = (2.0 * rho - 1.0) / (rho + 1.0);
+        m_alphaF = rho / (rho + 1.0);
+        m_gamma  = 0.5 - m_alphaM + m_alphaF;
+        m_beta   = 0.25 * (1.0 - m_alphaM + m_alphaF) * (1.0 - m_alphaM + m_alphaF);
+        std::cout << "generalized-alpha integrator, rho_inf " << rho << std::endl;
+    }
+
+    // dt of input.txt is reduced to the stable step size if necessary
+    if (EXPLICIT) {
+        double dt_stable = findStableStep();
+        std::cout << "explicit integrator, stable step size " << dt_stable << std::endl;
+        if (m_dt > dt_stable) {
+            m_dt = dt_stable;
+            std::cout << "step size is reduced to " << m_dt << std::endl;
+        }
+    }
+
+    if (PROJECTIVE) {
+        findProjectiveSystem();
+        std::cout << "projective dynamics, " << m_SimPar->pd_iter() << " iterations per step" << std::endl;
+    }
 }
 
 //* ========================================= //
@@ -61,23 +224,73 @@ void SolverImpl::dynamic() {
     VectorNodes vel(m_SimGeo->nn());
     for (int i = 0; i < m_SimGeo->nn(); i++)
         vel[i].fill(0.0);
+
+    if (GEN_ALPHA)
+        initAlphaState(vel);
     
     //*------time stepping---------
     // stopped when |vel|<=1e-8
     int ist = 0;
     double vel_magnitude = 0;
     int counter = 0;
+    double time = 0.0;
+
+    // velocity of the last step, for the step size control
+    VectorNodes vel_prev(m_SimGeo->nn());
 
-    writeToFiles(ist);
+    if (m_SimPar->restart()) {
+        readCheckpoint(ist, time, counter, nodes_curr, vel);
+        std::cout << "restart from the checkpoint of step " << ist << ", t = " << time << std::endl;
+    }
+    else
+        writeToFiles(ist, time, vel);
     do {
         ist++;
-        if (!step(ist, nodes_curr, m_SimGeo->m_nodes, vel)) {
-            std::cerr << "Solver did not converge in " << m_SimPar->iter_lim()
-                        << " iterations at step " << ist << std::endl;
-            throw "Cannot converge! Program terminated";
+        if (EXPLICIT || PROJECTIVE) {
+            if (EXPLICIT)
+                explicitStep(m_SimGeo->m_nodes, vel);
+            else
+                projectiveStep(m_SimGeo->m_nodes, vel);
+            time += m_dt;
+            if (WRITE_OUTPUT)
+                writeToFiles(ist, time, vel);
+
+            vel_magnitude = 0;
+            for (int i = 0; i < m_SimGeo->nn(); i++)
+                vel_magnitude += vel[i].dot(vel[i]);
+            vel_magnitude = sqrt(vel_magnitude);
+            // steps are cheap, the progress is only shown with the output frequency
+            if ((m_SimPar->out_freq() > 0 && ist % m_SimPar->out_freq() == 0) || ist > m_SimPar->nst())
+                std::cout << "Step " << ist << ", t = " << time << ", ||vel|| = " << vel_magnitude << std::endl;
+            counter = (vel_magnitude <= 1e-8) ? counter+1 : 0;
+            if (m_SimPar->checkpoint_freq() > 0 && ist % m_SimPar->checkpoint_freq() == 0)
+                writeCheckpoint(ist, time, counter, m_SimGeo->m_nodes, vel);
+            if (ist > m_SimPar->nst())
+                break;
+            continue;
+        }
+
+        vel_prev = vel;
+        int iter_start = m_numIterations;
+        while (!tryStep(ist, nodes_curr, m_SimGeo->m_nodes, vel)) {
+            if (!ADAPTIVE_STEP || m_dt <= m_SimPar->dt_min()) {
+                std::cerr << "Solver did not converge in " << m_SimPar->iter_lim()
+                            << " iterations at step " << ist << std::endl;
+                throw "Cannot converge! Program terminated";
+            }
+            // roll back to the last converged configuration and retry with half the step size
+            for (int i = 0; i < m_SimGeo->nn(); i++)
+                m_SimGeo->m_nodes[i] = nodes_curr[i];
+            setStepSize(std::max(0.5 * m_dt, m_SimPar->dt_min()));
+            std::cout << "step rejected, retry with dt = " << m_dt << std::endl;
+        }
+        time += m_dt;
+        if (ADAPTIVE_STEP) {
+            std::cout << "t = " << time << ", dt = " << m_dt << std::endl;
+            adaptStepSize(m_numIterations - iter_start, vel_prev, vel);
         }
         if (WRITE_OUTPUT)
-            writeToFiles(ist);
+            writeToFiles(ist, time, vel);
 
         vel_magnitude = 0;
         for (int i = 0; i < m_SimGeo->nn(); i++) {
@@ -91,12 +304,16 @@ void SolverImpl::dynamic() {
         else {
             counter = 0;
         }
+        if (m_SimPar->checkpoint_freq() > 0 && ist % m_SimPar->checkpoint_freq() == 0)
+            writeCheckpoint(ist, time, counter, nodes_curr, vel);
         if (ist > m_SimPar->nst()) {
             break;
         }
     }
     while ( counter < 10 );
     //*----------------------------
+    finishOutput();
+    printNewtonStats();
 }
 
 // Static Simulation
@@ -110,46 +327,92 @@ void SolverImpl::statics() {
     for (int i = 0; i < m_SimGeo->nn(); i++)
         nodes_curr[i] = m_SimGeo->m_nodes[i];
     
+    int ist_start = 1;
+    if (m_SimPar->restart()) {
+        VectorNodes vel;
+        double load;
+        int counter;
+        readCheckpoint(ist_start, load, counter, nodes_curr, vel);
+        std::cout << "restart from the checkpoint of increment " << ist_start << ", load factor " << load << std::endl;
+        ist_start++;
+    }
+
     //*------increment---------
-    for (int ist = 1; ist <= m_SimPar->nst(); ist++) {
-        if (!increment(ist, nodes_curr, m_SimGeo->m_nodes)) {
+    for (int ist = ist_start; ist <= m_SimPar->nst(); ist++) {
+        // Newton starts from the predicted configuration, or from the last one if that fails
+        predict(nodes_curr, m_SimGeo->m_nodes);
+        bool converged = increment(ist, nodes_curr, m_SimGeo->m_nodes);
+        if (!converged && m_SimPar->predictor() > 0 && m_numHistory > 0) {
+            std::cout << "predictor rejected, increment " << ist << " restarts from the last configuration" << std::endl;
+            for (int i = 0; i < m_SimGeo->nn(); i++)
+                m_SimGeo->m_nodes[i] = nodes_curr[i];
+            converged = increment(ist, nodes_curr, m_SimGeo->m_nodes);
+        }
+        if (!converged) {
             std::cerr << "Solver did not converge in " << m_SimPar->iter_lim()
                       << " iterations at increment " << ist << std::endl;
             throw "Cannot converge! Program terminated";
         }
         if (WRITE_OUTPUT)
-            writeToFiles(ist);
+            writeToFiles(ist, ist);
+        // the load factor takes the place of the time
+        if (m_SimPar->checkpoint_freq() > 0 && ist % m_SimPar->checkpoint_freq() == 0)
+            writeCheckpoint(ist, ist * m_incRatio, 0, nodes_curr, VectorNodes());
     }
     //*------------------------
+    finishOutput();
+    printNewtonStats();
 }
 
-// TODO: implement Newmark-beta method
-// TODO: should consider the acceleration!
+// adaptive stepping also rejects steps whose linear solves failed
+bool SolverImpl::tryStep(const int ist, VectorNodes& x, VectorNodes& x_new, VectorNodes& vel) {
+    if (!ADAPTIVE_STEP)
+        return step(ist, x, x_new, vel);
+    try {
+        return step(ist, x, x_new, vel);
+    }
+    catch (const char* msg) {
+        std::cerr << msg << " at step " << ist << std::endl;
+        return false;
+    }
+}
 
-// Time stepping using backward Euler
+// Time stepping using backward Euler or generalized-alpha
 bool SolverImpl::step(const int ist, VectorNodes& x, VectorNodes& x_new, VectorNodes& vel) {
     std::cout << "--------Step " << ist << "--------" << std::endl;
 
+    // Newton starts from the predicted configuration
+    predict(x, x_new, vel);
+
     // apply Newton-Raphson Method
+    double error_prev = 0.0;
     for (int niter = 0; niter < m_SimPar->iter_lim(); niter++) {
         Timer t;
 
         VectorN rhs(m_numNeumann); rhs.fill(0.0);
-        SparseEntries entries_full;
 
         //Timer t1;
         // calculate derivatives of energy functions
         VectorN dEdq(m_numTotal); dEdq.fill(0.0);
-        findDEnergy(dEdq, entries_full);
+        findDEnergy(dEdq, m_jacobian);
         //std::cout << t1.elapsed() << '\t';
 
         // calculate residual vector
-        findResidual(vel, x, x_new, dEdq, rhs);
+        if (GEN_ALPHA)
+            findResidualAlpha(vel, x, x_new, dEdq, rhs);
+        else
+            findResidual(vel, x, x_new, dEdq, rhs);
 
         // display residual
         double error = rhs.norm();
         std::cout << "iter" << niter+1 << '\t' << "error = " << error << '\t';
 
+        // diverged, there is no point in further iterations
+        if (!finiteValue(error)) {
+            std::cout << std::endl;
+            return false;
+        }
+
         // check convergence
         if (error < m_tol) {
             // calculate new velocity vector
@@ -157,7 +420,14 @@ bool SolverImpl::step(const int ist, VectorNodes& x, VectorNodes& x_new, VectorN
                 for (int i = 0; i < x.size(); i++)
                     vel[i] = (x_new[i] - x[i]) / dt;
             };
-            findVel(m_SimPar->dt(), vel);
+            m_velPrev = vel;
+            m_dtPrev = m_dt;
+            m_numHistory++;
+            m_numSteps++;
+            if (GEN_ALPHA)
+                updateAlphaState(x, x_new, dEdq, vel);
+            else
+                findVel(m_dt, vel);
             // save current nodal position for next step
             for (int i = 0; i < m_SimGeo->nn(); i++)
                 x[i] = x_new[i];
@@ -167,11 +437,18 @@ bool SolverImpl::step(const int ist, VectorNodes& x, VectorNodes& x_new, VectorN
         }
 
         // calculate jacobian matrix
-        SpMatrix jacobian(m_numNeumann, m_numNeumann);
-        findJacobian(entries_full, jacobian);
+        findJacobian(m_jacobian);
+
+        // inexact Newton solves only as accurately as the Newton convergence requires
+        if (INEXACT_NEWTON)
+            m_linearSolver->setTolerance(findForcingTerm(niter, error, error_prev));
+
+        // modified Newton keeps the last factorization if possible
+        bool refactor = refactorJacobian(niter, error, error_prev);
+        error_prev = error;
 
         // solve for new dof vector
-        findDofnew(rhs, jacobian, x_new);
+        findDofnew(rhs, m_jacobian, x_new, refactor);
 
         // display iteration time
         std::cout << "t_iter = " << t.elapsed() << " ms" << std::endl;
@@ -179,20 +456,128 @@ bool SolverImpl::step(const int ist, VectorNodes& x, VectorNodes& x_new, VectorN
     return false;
 }
 
+// Static equilibrium by FIRE relaxation (Bitzek et al., 2006) under the full external load
+// damped explicit dynamics: the velocity is turned towards the force while the power F.v is
+// positive, the motion is stopped and the step size reduced when it turns negative.
+// As in dynamic relaxation, the masses are fictitious: the largest Gershgorin row sum of the initial
+// stiffness of each node, so that all frequencies are below 1 and the stable step size is about 2.
+// Same convergence criterion as the Newton increments, |f_ext - dE/dq| < tol on the free dofs.
+void SolverImpl::relaxation() {
+    const int    N_MIN       = 5;       // steps with positive power before the step size grows
+    const double F_INC       = 1.1;
+    const double F_DEC       = 0.5;
+    const double ALPHA_START = 0.1;
+    const double F_ALPHA     = 0.99;
+    const double DT_START    = 0.1;
+    const double DT_MAX      = 1.0;
+
+    VectorN rowsum;
+    findStiffnessRowSums(rowsum);
+    // isotropic nodal masses, the membrane stiffness turns out of plane with the rotation of the plate
+    VectorN mass(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        mass(idof) = rowsum.segment<3>(m_dofsToFull[idof] / 3 * 3).maxCoeff();
+    if (mass.minCoeff() <= 0.0)
+        throw "FIRE relaxation requires a stiffness on every free dof";
+
+    double dt = DT_START;
+    double alpha = ALPHA_START;
+    int npositive = 0;
+    std::cout << "FIRE relaxation" << std::endl;
+
+    VectorNodes& x = m_SimGeo->m_nodes;
+    VectorN v = VectorN::Zero(m_numNeumann);
+    VectorN F(m_numNeumann);
+    VectorN dEdq(m_numTotal);
+    for (int iter = 0; iter < m_SimPar->relax_iter(); iter++) {
+        dEdq.fill(0.0);
+        findDEnergy(dEdq, m_jacobian);
+        for (int idof = 0; idof < m_numNeumann; idof++)
+            F(idof) = m_SimBC->m_fext(m_dofsToFull[idof]) - dEdq(m_dofsToFull[idof]);
+
+        double error = F.norm();
+        if (iter % 1000 == 0)
+            std::cout << "iter" << iter << '\t' << "error = " << error << '\t' << "dt = " << dt << std::endl;
+        if (error < m_tol) {
+            std::cout << "converged in " << iter << " iterations, error = " << error << std::endl;
+            if (WRITE_OUTPUT)
+                writeToFiles(m_SimPar->nst(), m_SimPar->nst());
+            finishOutput();
+            printNewtonStats();
+            return;
+        }
+
+        // the velocity is mixed with the direction of the acceleration, F / mass
+        double power = F.dot(v);
+        if (power > 0.0) {
+            VectorN acc = F.cwiseQuotient(mass);
+            v = (1.0 - alpha) * v + alpha * v.norm() / acc.norm() * acc;
+            if (++npositive > N_MIN) {
+                dt = std::min(F_INC * dt, DT_MAX);
+                alpha *= F_ALPHA;
+            }
+        }
+        else {
+            v.setZero();
+            dt *= F_DEC;
+            alpha = ALPHA_START;
+            npositive = 0;
+        }
+
+        // semi-implicit Euler
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int idof = 0; idof < m_numNeumann; idof++) {
+            int pos = m_dofsToFull[idof];
+            v(idof) += dt * F(idof) / mass(idof);
+            x[pos / 3][pos % 3] += dt * v(idof);
+        }
+        m_numIterations++;
+    }
+    std::cerr << "FIRE relaxation did not converge in " << m_SimPar->relax_iter() << " iterations" << std::endl;
+    throw "Cannot converge! Program terminated";
+}
+
+//  Symplectic Euler with the lumped mass, the damping term is implicit
+//  v(t_n+1) = [v(t_n) + dt / m_i * (F_ext - dE/dq(q(t_n)))] / (1 + dt * c / m_i)
+//  q(t_n+1) = q(t_n) + dt * v(t_n+1)
+//
+void SolverImpl::explicitStep(VectorNodes& x, VectorNodes& vel) {
+    double dt = m_dt;
+    // viscous damping as in findResidual()
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+
+    VectorN dEdq(m_numTotal); dEdq.fill(0.0);
+    findDEnergy(dEdq, m_jacobian);
+
+    #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        for (int j = 0; j < m_SimGeo->nsd(); j++) {
+            int pos = i * m_SimGeo->nsd() + j;
+            if (m_fullToDofs[pos] == -1)
+                continue;
+            double m = m_SimGeo->m_mass(pos);
+            vel[i][j] = (vel[i][j] + dt / m * (m_SimBC->m_fext(pos) - dEdq(pos))) / (1.0 + dt * nu * area / m);
+            x[i][j] += dt * vel[i][j];
+        }
+    }
+}
+
 // Static load increment
 bool SolverImpl::increment(const int ist, VectorNodes& x, VectorNodes& x_new) {
     std::cout << "--------Increment " << ist << "--------" << std::endl;
 
     // apply Newton-Raphson Method
+    double error_prev = 0.0;
     for (int niter = 0; niter < m_SimPar->iter_lim(); niter++) {
         Timer t;
 
         VectorN rhs(m_numNeumann); rhs.fill(0.0);
-        SparseEntries entries_full;
 
         // calculate derivatives of energy functions
         VectorN dEdq(m_numTotal); dEdq.fill(0.0);
-        findDEnergy(dEdq, entries_full);
+        findDEnergy(dEdq, m_jacobian);
 
         // calculate residual vector
         findResidual(ist, x, x_new, dEdq, rhs);
@@ -201,8 +586,20 @@ bool SolverImpl::increment(const int ist, VectorNodes& x, VectorNodes& x_new) {
         double error = rhs.norm();
         std::cout << "iter" << niter+1 << '\t' << "error = " << error << '\t';
 
+        // diverged, there is no point in further iterations
+        if (!finiteValue(error)) {
+            std::cout << std::endl;
+            return false;
+        }
+
         // check convergence
         if (error < m_tol) {
+            if (m_SimPar->predictor() > 0) {
+                m_xPrev2.swap(m_xPrev);
+                m_xPrev = x;
+                m_numHistory++;
+            }
+            m_numSteps++;
             // save current nodal position for next step
             for (int i = 0; i < m_SimGeo->nn(); i++)
                 x[i] = x_new[i];
@@ -212,11 +609,18 @@ bool SolverImpl::increment(const int ist, VectorNodes& x, VectorNodes& x_new) {
         }
 
         // calculate jacobian matrix
-        SpMatrix jacobian(m_numNeumann, m_numNeumann);
-        findJacobian(entries_full, jacobian);
+        findJacobian(m_jacobian);
+
+        // inexact Newton solves only as accurately as the Newton convergence requires
+        if (INEXACT_NEWTON)
+            m_linearSolver->setTolerance(findForcingTerm(niter, error, error_prev));
+
+        // modified Newton keeps the last factorization if possible
+        bool refactor = refactorJacobian(niter, error, error_prev);
+        error_prev = error;
 
         // solve for new dof vector
-        findDofnew(rhs, jacobian, x_new);
+        findDofnew(rhs, m_jacobian, x_new, refactor);
 
         // display iteration time
         std::cout << "t_iter = " << t.elapsed() << " ms" << std::endl;
@@ -224,14 +628,75 @@ bool SolverImpl::increment(const int ist, VectorNodes& x, VectorNodes& x_new) {
     return false;
 }
 
-// write data to files
-void SolverImpl::writeToFiles(const int ist) {
+// Statics: polynomial extrapolation of the converged configurations of the last increments,
+// the load increments are uniform
+//   linear:    x_{n+1} = 2 x_n - x_{n-1}
+//   quadratic: x_{n+1} = 3 x_n - 3 x_{n-1} + x_{n-2}
+void SolverImpl::predict(const VectorNodes& x, VectorNodes& x_new) const {
+    int order = std::min(m_SimPar->predictor(), m_numHistory);
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        if (order == 1)
+            x_new[i] = 2.0 * x[i] - m_xPrev[i];
+        else if (order == 2)
+            x_new[i] = 3.0 * x[i] - 3.0 * m_xPrev[i] + m_xPrev2[i];
+        else
+            x_new[i] = x[i];
+    }
+}
+
+// Dynamics: Taylor expansion of the motion, the acceleration is the difference of the last velocities
+//   linear:    x_{n+1} = x_n + dt * v_n
+//   quadratic: x_{n+1} = x_n + dt * v_n + dt^2 / 2 * (v_n - v_{n-1}) / dt_{n-1}
+// generalized-alpha always uses the linear predictor: Newton does not converge from x_n for large
+// steps, and the extrapolated acceleration of stiff membrane modes is too oscillatory
+void SolverImpl::predict(const VectorNodes& x, VectorNodes& x_new, const VectorNodes& vel) const {
+    int order = std::min(m_SimPar->predictor(), m_numHistory + 1);
+    if (GEN_ALPHA)
+        order = 1;
+    double dt = m_dt;
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        x_new[i] = x[i];
+        if (order >= 1)
+            x_new[i] += dt * vel[i];
+        if (order == 2)
+            x_new[i] += 0.5 * dt * dt / m_dtPrev * (vel[i] - m_velPrev[i]);
+    }
+}
+
+// write data to files, time: simulated time, the increment for the static solvers
+// vel is empty for the static solvers
+void SolverImpl::writeToFiles(const int ist, const double time, const VectorNodes& vel) {
     if (ist % m_SimPar->out_freq() != 0)
         return;
     if (m_SimPar->out_freq() == -1)
         if (ist != m_SimPar->nst())
             return;
 
+    // fields need the state of the solver, they are evaluated before the frame is handed over
+    if (m_xdmf && m_SimPar->out_fields() != 0)
+        findOutputFields(ist, vel, m_outFields);
+
+    if (m_writer)
+        m_writer->push(ist, time, m_SimGeo->m_nodes, m_outFields);
+    else
+        writeFrame(ist, time, m_SimGeo->m_nodes, m_outFields);
+}
+
+// serialization of an output frame, called by the writer thread if the output is asynchronous
+void SolverImpl::writeFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields) {
+    if (m_xdmf) {
+        m_xdmf->writeFrame(ist, time, nodes, fields);
+        return;
+    }
+    if (m_trajectory) {
+        m_trajectory->writeFrame(ist, nodes);
+        return;
+    }
+    if (m_compressed) {
+        m_compressed->writeFrame(ist, nodes);
+        return;
+    }
+
     // output files
     std::string filepath = m_SimPar->outputPath();
     std::string filename;
@@ -239,11 +704,193 @@ void SolverImpl::writeToFiles(const int ist) {
     sprintf(buffer, "result%05d.txt", ist);
     filename.assign(buffer);
     std::ofstream myfile((filepath+filename).c_str());
+    // nodes in the original numbering
     for (int k = 0; k < m_SimGeo->nn(); k++) {
+        const Eigen::Vector3d& node = nodes[m_SimGeo->newNode(k)];
         myfile << std::setprecision(8) << std::fixed
-                << m_SimGeo->m_nodes[k][0] << '\t'
-                << m_SimGeo->m_nodes[k][1] << '\t'
-                << m_SimGeo->m_nodes[k][2] << std::endl;
+                << node[0] << '\t'
+                << node[1] << '\t'
+                << node[2] << '\n';
+    }
+}
+
+// hash of everything the state of a checkpoint depends on: the reference configuration, the
+// boundary conditions and the parameters of the model and of the integrator
+// nst only changes the end of a dynamic run, which can be extended by a restart
+uint64_t SolverImpl::findStateHash() const {
+    uint64_t h = 14695981039346656037ULL;
+    for (auto &node : m_SimGeo->m_nodes)
+        Checkpoint::hash(h, node.data(), 3 * sizeof(double));
+    Checkpoint::hash(h, m_SimBC->m_dirichletDofs.data(), m_SimBC->m_dirichletDofs.size() * sizeof(m_SimBC->m_dirichletDofs[0]));
+
+    double real[] = {m_SimPar->dt(), m_SimPar->E_modulus(), m_SimPar->nu(), m_SimPar->rho(), m_SimPar->thk(),
+                     m_SimPar->vis(), m_SimPar->gconst(), m_SimPar->rho_inf()};
+    int integer[] = {m_SimPar->solver_op(), m_SimPar->integrator(), m_SimPar->adaptive_dt(),
+                     m_SimPar->reorder_op(), m_SimPar->out_format(), m_SimPar->out_fields(),
+                     m_SimPar->solver_op() ? 0 : m_SimPar->nst()};
+    Checkpoint::hash(h, real, sizeof(real));
+    Checkpoint::hash(h, integer, sizeof(integer));
+    return h;
+}
+
+// state at the end of step ist, output files are complete up to this step
+void SolverImpl::writeCheckpoint(const int ist, const double time, const int counter, const VectorNodes& x, const VectorNodes& vel) {
+    if (m_writer)
+        m_writer->flush();
+    long bytes = 0;
+    if (m_trajectory)
+        bytes = m_trajectory->bytesWritten();
+    if (m_compressed)
+        bytes = m_compressed->bytesWritten();
+    if (m_xdmf)
+        bytes = m_xdmf->bytesWritten();
+
+    m_checkpoint->begin();
+    m_checkpoint->put(bytes);
+    m_checkpoint->put(ist);
+    m_checkpoint->put(time);
+    m_checkpoint->put(counter);
+    m_checkpoint->put(m_dt);
+    m_checkpoint->put(x);
+    m_checkpoint->put(vel);
+    // generalized-alpha
+    m_checkpoint->put(m_acc);
+    m_checkpoint->put(m_dEdqPrev);
+    // predictor
+    m_checkpoint->put(m_numHistory);
+    m_checkpoint->put(m_xPrev);
+    m_checkpoint->put(m_xPrev2);
+    m_checkpoint->put(m_velPrev);
+    m_checkpoint->put(m_dtPrev);
+    // Newton
+    m_checkpoint->put(m_forcing);
+    m_checkpoint->put(m_numIterations);
+    m_checkpoint->put(m_numFactorizations);
+    m_checkpoint->put(m_numSteps);
+    m_checkpoint->commit();
+    // the factorization is not part of the state, modified Newton refactors as after a restart
+    m_factorized = false;
+    std::cout << "checkpoint written at " << (DYNAMIC_SOLVER ? "step " : "increment ") << ist << std::endl;
+}
+
+// same order as writeCheckpoint(), the size of the output files is read by initSolver()
+// modified Newton refactors the jacobian in the first iteration, as the run that wrote the checkpoint
+void SolverImpl::readCheckpoint(int& ist, double& time, int& counter, VectorNodes& x, VectorNodes& vel) {
+    m_checkpoint->get(ist);
+    m_checkpoint->get(time);
+    m_checkpoint->get(counter);
+    m_checkpoint->get(m_dt);
+    m_checkpoint->get(x);
+    m_checkpoint->get(vel);
+    m_checkpoint->get(m_acc);
+    m_checkpoint->get(m_dEdqPrev);
+    m_checkpoint->get(m_numHistory);
+    m_checkpoint->get(m_xPrev);
+    m_checkpoint->get(m_xPrev2);
+    m_checkpoint->get(m_velPrev);
+    m_checkpoint->get(m_dtPrev);
+    m_checkpoint->get(m_forcing);
+    m_checkpoint->get(m_numIterations);
+    m_checkpoint->get(m_numFactorizations);
+    m_checkpoint->get(m_numSteps);
+
+    if (x.size() != m_SimGeo->nn())
+        throw "the checkpoint does not match the mesh";
+    for (int i = 0; i < m_SimGeo->nn(); i++)
+        m_SimGeo->m_nodes[i] = x[i];
+    m_factorized = false;
+}
+
+// waits for the frames of the writer thread, they are part of the simulation time
+void SolverImpl::finishOutput() {
+    if (m_writer) {
+        Timer t;
+        m_writer->finish();
+        std::cout << "output frames written: " << m_writer->written() << ", dropped: " << m_writer->dropped()
+                  << ", solver waited " << m_writer->blocked() << " s, final flush " << 1e-3 * t.elapsed() << " s" << std::endl;
+    }
+    if (m_compressed)
+        std::cout << "compressed trajectory: " << m_compressed->bytesWritten() << " bytes" << std::endl;
+    if (m_checkpoint)
+        m_checkpoint->finish();
+}
+
+// element fields are written in the element order of the output, the triangles of the solver
+// are sorted by the node reordering, each hinge shares its energy with its two triangles
+void SolverImpl::findOutputMaps() {
+    auto key = [] (int a, int b, int c) {
+        std::array<int, 3> k = {a, b, c};
+        std::sort(k.begin(), k.end());
+        return k;
+    };
+    std::map<std::array<int, 3>, int> elements;
+    for (int i = 0; i < m_SimGeo->nel(); i++)
+        elements[key(m_SimGeo->m_mesh[i][0]-1, m_SimGeo->m_mesh[i][1]-1, m_SimGeo->m_mesh[i][2]-1)] = i;
+    auto findElement = [this, &key, &elements] (int a, int b, int c) {
+        auto it = elements.find(key(m_SimGeo->oldNode(a), m_SimGeo->oldNode(b), m_SimGeo->oldNode(c)));
+        if (it == elements.end())
+            throw "the topology of the solver does not match the mesh";
+        return it->second;
+    };
+
+    m_outElement.resize(m_SimGeo->m_triangles.size());
+    for (int k = 0; k < m_outElement.size(); k++) {
+        const Eigen::Vector3i& tri = m_SimGeo->m_triangles[k];
+        m_outElement[k] = findElement(tri[0], tri[1], tri[2]);
+    }
+    m_outHinge.resize(m_SimGeo->m_hinges.size());
+    for (int k = 0; k < m_outHinge.size(); k++) {
+        const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+        m_outHinge[k] << findElement(ihinge[0], ihinge[1], ihinge[2]), findElement(ihinge[0], ihinge[1], ihinge[3]);
+    }
+}
+
+// fields of an output frame of the XDMF export, in the order of XdmfWriter
+// residual force: f_ext - dE/dq at the current load, the reaction force on constrained dofs,
+// inertia and damping are not included
+void SolverImpl::findOutputFields(const int ist, const VectorNodes& vel, VectorN& fields) {
+    int nn = m_SimGeo->nn();
+    int nel = m_SimGeo->nel();
+    int select = m_SimPar->out_fields();
+    const VectorNodes& x = m_SimGeo->m_nodes;
+    fields.resize(XdmfWriter::fieldSize(select, nn, nel));
+    if (materialChanged())
+        findMaterialState();
+
+    int pos = 0;
+    if (select & XdmfWriter::VELOCITY) {
+        for (int k = 0; k < nn; k++)
+            fields.segment<3>(pos + 3*k) = vel.empty() ? Eigen::Vector3d::Zero() : vel[m_SimGeo->newNode(k)];
+        pos += 3 * nn;
+    }
+    if (select & XdmfWriter::FORCE) {
+        VectorN dEdq = VectorN::Zero(m_numTotal);
+        DEStretch(dEdq, nullptr);
+        DEShear(dEdq, nullptr);
+        DEBend(dEdq, nullptr);
+        double load = DYNAMIC_SOLVER ? 1.0 : double(ist) / double(m_SimPar->nst());
+        for (int k = 0; k < nn; k++) {
+            int i = m_SimGeo->newNode(k);
+            fields.segment<3>(pos + 3*k) = load * m_SimBC->m_fext.segment<3>(3*i) - dEdq.segment<3>(3*i);
+        }
+        pos += 3 * nn;
+    }
+    if (select & XdmfWriter::STRAIN) {
+        for (int k = 0; k < m_SimGeo->m_triangles.size(); k++) {
+            const Eigen::Vector3i& tri = m_SimGeo->m_triangles[k];
+            double area = 0.5 * (x[tri[1]] - x[tri[0]]).cross(x[tri[2]] - x[tri[0]]).norm();
+            fields(pos + m_outElement[k]) = area / m_SimGeo->m_area[k] - 1.0;
+        }
+        pos += nel;
+    }
+    if (select & XdmfWriter::BENDING) {
+        fields.segment(pos, nel).setZero();
+        for (int k = 0; k < m_SimGeo->m_hinges.size(); k++) {
+            const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+            Bending Ebend(x[ihinge[0]], x[ihinge[1]], x[ihinge[2]], x[ihinge[3]], m_kb(k), m_SimGeo->m_psi0[k]);
+            fields(pos + m_outHinge[k][0]) += 0.5 * Ebend.energy();
+            fields(pos + m_outHinge[k][1]) += 0.5 * Ebend.energy();
+        }
     }
 }
 
@@ -251,17 +898,27 @@ void SolverImpl::writeToFiles(const int ist) {
 //*       Implementation of subroutines       //
 //* ========================================= //
 
-void SolverImpl::findDEnergy(VectorN& dEdq, SparseEntries& entries_full) {
-    DEStretch(dEdq, entries_full);
-    DEShear(dEdq, entries_full);
-    DEBend(dEdq, entries_full);
+// local jacobians are scattered directly into the values of the cached pattern
+// matrix-free solvers only need the gradient here
+void SolverImpl::findDEnergy(VectorN& dEdq, SpMatrix& jacobian) {
+    if (materialChanged())
+        findMaterialState();
+
+    double* jac = nullptr;
+    if (!MATRIX_FREE && !GRADIENT_ONLY) {
+        jacobian.coeffs().setZero();
+        jac = jacobian.valuePtr();
+    }
+    DEStretch(dEdq, jac);
+    DEShear(dEdq, jac);
+    DEBend(dEdq, jac);
 }
 
 //  Static version
 //  f_i = dE/dq - F_ext
 //
 void SolverImpl::findResidual(const int ist, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs) {
-    double dt = m_SimPar->dt();
+    double dt = m_dt;
 
     // only take the entries that are NOT in Dirichlet BC
     // CAUTION: if Dirichlet BC is nonzero, need to consider the influence of the Dirichlet BC
@@ -283,7 +940,7 @@ void SolverImpl::findResidual(const int ist, const VectorNodes& x, const VectorN
 //  f_i = m_i * (q_i(t_n+1) - q_i(t_n)) / dt^2 - m_i * v(t_n) / dt + dE/dq - F_ext
 //
 void SolverImpl::findResidual(const VectorNodes& vel, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs) {
-    double dt = m_SimPar->dt();
+    double dt = m_dt;
 
     // TODO: better model of viscous damping
     double nu = m_SimPar->vis();
@@ -312,53 +969,136 @@ void SolverImpl::findResidual(const VectorNodes& vel, const VectorNodes& x, cons
     }
 }
 
+//  Generalized-alpha version, the balance of forces is enforced at t_n+1-alpha_f:
+//  f_i = [m_i * a_i(t_n+1-alpha_m) + c * v_i(t_n+1-alpha_f) + alpha_f * dE/dq(t_n) - F_ext] / (1 - alpha_f) + dE/dq
+//  with the Newmark relations of a(t_n+1) and v(t_n+1) to q(t_n+1). The internal force is
+//  interpolated between t_n and t_n+1 instead of evaluated at the interpolated configuration,
+//  so that energy derivatives are only needed at q(t_n+1). The scaling by 1 / (1 - alpha_f)
+//  keeps the stiffness part of the jacobian unchanged.
+//
+void SolverImpl::findResidualAlpha(const VectorNodes& vel, const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorN& rhs) {
+    double dt = m_dt;
+
+    // viscous damping as in findResidual()
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        for (int j = 0; j < m_SimGeo->nsd(); j++) {
+            int pos = i * m_SimGeo->nsd() + j;
+            int pos_dof = m_fullToDofs[pos];
+            if (pos_dof != -1) {
+                double a = m_acc[i][j];
+                double v = vel[i][j];
+                double a_new = (x_new[i][j] - x[i][j] - dt * v - dt*dt * (0.5 - m_beta) * a) / (m_beta * dt*dt);
+                double v_new = v + dt * ((1.0 - m_gamma) * a + m_gamma * a_new);
+                double a_m = (1.0 - m_alphaM) * a_new + m_alphaM * a;
+                double v_f = (1.0 - m_alphaF) * v_new + m_alphaF * v;
+                rhs(pos_dof) = (m_SimGeo->m_mass(pos) * a_m + nu * area * v_f
+                                + m_alphaF * m_dEdqPrev(pos) - m_SimBC->m_fext(pos)) / (1.0 - m_alphaF)
+                               + dEdq(pos);
+            }
+        }
+    }
+}
+
+// the initial acceleration is in equilibrium with the initial forces
+void SolverImpl::initAlphaState(const VectorNodes& vel) {
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+
+    m_dEdqPrev.resize(m_numTotal); m_dEdqPrev.fill(0.0);
+    findDEnergy(m_dEdqPrev, m_jacobian);
+
+    m_acc.resize(m_SimGeo->nn());
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        m_acc[i].fill(0.0);
+        for (int j = 0; j < m_SimGeo->nsd(); j++) {
+            int pos = i * m_SimGeo->nsd() + j;
+            if (m_fullToDofs[pos] != -1)
+                m_acc[i][j] = (m_SimBC->m_fext(pos) - m_dEdqPrev(pos) - nu * area * vel[i][j])
+                              / m_SimGeo->m_mass(pos);
+        }
+    }
+}
+
+// Newmark update of the acceleration and the velocity of a converged step
+void SolverImpl::updateAlphaState(const VectorNodes& x, const VectorNodes& x_new, const VectorN& dEdq, VectorNodes& vel) {
+    double dt = m_dt;
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        for (int j = 0; j < m_SimGeo->nsd(); j++) {
+            if (m_fullToDofs[i * m_SimGeo->nsd() + j] == -1)
+                continue;
+            double a = m_acc[i][j];
+            double a_new = (x_new[i][j] - x[i][j] - dt * vel[i][j] - dt*dt * (0.5 - m_beta) * a) / (m_beta * dt*dt);
+            vel[i][j] += dt * ((1.0 - m_gamma) * a + m_gamma * a_new);
+            m_acc[i][j] = a_new;
+        }
+    }
+    m_dEdqPrev = dEdq;
+}
+
 //
 //  J_ij = m_i / dt^2 * delta_ij + d^2 E / dq_i dq_j
+//  generalized-alpha: J_ij = [(1 - alpha_m) m_i / (beta dt^2) + (1 - alpha_f) gamma c / (beta dt)] / (1 - alpha_f) * delta_ij + d^2 E / dq_i dq_j
 //
-void SolverImpl::findJacobian(SparseEntries& entries_full, SpMatrix& jacobian) {
+void SolverImpl::findJacobian(SpMatrix& jacobian) {
+    if (MATRIX_FREE) {
+        findJacobianDiagonal(m_jacobianDiag);
+        return;
+    }
     if (DYNAMIC_SOLVER) {
-        double dt = m_SimPar->dt();
-        // TODO: better model of viscous damping
-        double nu = m_SimPar->vis();
-        double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
-                      / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
-        for (int i = 0; i < m_numTotal; i++) {
-            // inertia term
-            double inertia = m_SimGeo->m_mass(i) / (dt*dt);
-            // viscous term
-            double viscous = nu * area / dt;
-            entries_full.emplace_back(Eigen::Triplet<double>(i, i, inertia + viscous));
-        }
+        double* jac = jacobian.valuePtr();
+        for (int idof = 0; idof < m_numNeumann; idof++)
+            jac[m_diagMap[idof]] += findDiagonalTerm(idof);
     }
-    SparseEntries entries_dof;
-    for (int p = 0; p < entries_full.size(); p++) {
-        int ifull = entries_full[p].row(), jfull = entries_full[p].col();
-        int idof = m_fullToDofs[ifull], jdof = m_fullToDofs[jfull];
-        if (idof != -1 && jdof != -1) {
-            // NOTE: 
-            // for Pardiso solver, only store the upper triangular part of jacobian!!
-            if (SOLVER_TYPE == 1) {
-                // skip the lower triangular part
-                if (idof > jdof)
-                    continue;
-            }
-            entries_dof.emplace_back(Eigen::Triplet<double>(idof, jdof, entries_full[p].value()));
-        }
+}
+
+// inertia and viscous terms of the jacobian, zero in static simulations
+double SolverImpl::findDiagonalTerm(const int idof) const {
+    if (!DYNAMIC_SOLVER)
+        return 0.0;
+
+    double dt = m_dt;
+    // viscous damping as in findResidual()
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+    if (GEN_ALPHA) {
+        double inertia = (1.0 - m_alphaM) * m_SimGeo->m_mass(m_dofsToFull[idof]) / (m_beta * dt*dt);
+        double viscous = (1.0 - m_alphaF) * m_gamma * nu * area / (m_beta * dt);
+        return (inertia + viscous) / (1.0 - m_alphaF);
     }
-    jacobian.setFromTriplets(entries_dof.begin(), entries_dof.end());
+    // inertia term
+    double inertia = m_SimGeo->m_mass(m_dofsToFull[idof]) / (dt*dt);
+    // viscous term
+    double viscous = nu * area / dt;
+    return inertia + viscous;
 }
 
 //
 //  q_{n+1} = q_n - J \ f
+//  if refactor is false, the factorization of an earlier jacobian is used
 //
-void SolverImpl::findDofnew(const VectorN& rhs, SpMatrix& jacobian, VectorNodes& x_new) {
+void SolverImpl::findDofnew(const VectorN& rhs, SpMatrix& jacobian, VectorNodes& x_new, const bool refactor) {
     VectorN dq(m_numNeumann); dq.fill(0.0);
 
     //Timer t1;
-    if (SOLVER_TYPE == 0)
-        sparseSolver(jacobian, rhs, dq);
-    else if (SOLVER_TYPE == 1)
-        pardisoInterface(jacobian, rhs, dq);
+    if (MATRIX_FREE) {
+        JacobianOperator J(this, m_jacobianDiag);
+        m_linearSolver->solveMatrixFree(J, rhs, dq);
+    }
+    else {
+        if (refactor) {
+            m_linearSolver->compute(jacobian);
+            m_factorized = true;
+            m_numFactorizations++;
+        }
+        m_linearSolver->solve(rhs, dq);
+    }
+    m_numIterations++;
     //std::cout << t1.elapsed() << '\t';
 
     // map the free part dof vector back to the full dof vector
@@ -372,341 +1112,835 @@ void SolverImpl::findDofnew(const VectorN& rhs, SpMatrix& jacobian, VectorNodes&
 }
 
 // ========================================= //
-//              Solver functions             //
+//          Other helper functions           //
 // ========================================= //
 
-// conjugate gradient solver from Eigen
-void SolverImpl::sparseSolver(const SpMatrix& A, const VectorN& rhs, VectorN& u) {
-    Eigen::ConjugateGradient<SpMatrix, Eigen::Upper> CGsolver;
-    CGsolver.compute(A);
-    if (CGsolver.info() != Eigen::Success)
-        throw "decomposition failed";
-
-    u = CGsolver.solve(rhs);
-    if (CGsolver.info() != Eigen::Success)
-        throw "solving failed";
-}
-
-// Pardiso solver interface
-void SolverImpl::pardisoInterface(SpMatrix& A, const VectorN& rhs, VectorN& u) {
-    // transform the sparse matrix to compressed view
-    A.makeCompressed();
-
-    int n = m_numNeumann;
-    int nonzeros = A.nonZeros();
-    // int innerSize = A.innerSize();
-    // int outerSize = A.outerSize();
-
-    /* Matrix data. */
-    int* ia = new int[n+1];
-    int* ja = new int[nonzeros];
-    double* a = new double[nonzeros];
-
-    /* RHS and solution vectors. */
-    double* b = new double[n];
-    double* x = new double[n];
-
-    // Construct CRS info from Eigen
-    // Convert matrix from 0-based C-notation to Fortran 1-based notation
-    for (int i = 0; i < n+1; i++)
-        ia[i] = A.outerIndexPtr()[i] + 1;
-    
-    for (int i = 0; i < nonzeros; i++)
-        ja[i] = A.innerIndexPtr()[i] + 1;
+// modified Newton: the jacobian is factorized again only if there is no factorization yet,
+// or if the residual contracted by less than refactor_ratio in the last iteration.
+// The first iteration of a step reuses the factorization of the previous step.
+bool SolverImpl::refactorJacobian(const int niter, const double error, const double error_prev) const {
+    if (!MODIFIED_NEWTON || !m_factorized)
+        return true;
+    return (niter > 0 && error > m_SimPar->refactor_ratio() * error_prev);
+}
 
-    for (int i = 0; i < nonzeros; i++)
-        a[i] = A.valuePtr()[i];
+// Eisenstat-Walker forcing term, choice 2 with gamma = 0.9 and alpha = 2:
+//   eta_k = gamma * (|f_k| / |f_k-1|)^alpha,  safeguarded by gamma * eta_k-1^alpha if that is above 0.1
+// the linear solve doesn't need to be more accurate than the Newton tolerance m_tol
+double SolverImpl::findForcingTerm(const int niter, const double error, const double error_prev) {
+    const double gamma = 0.9;
+    const double alpha = 2.0;
+    double eta_max = m_SimPar->forcing_max();
+
+    double eta = eta_max;
+    if (niter > 0) {
+        eta = gamma * pow(error / error_prev, alpha);
+        double safeguard = gamma * pow(m_forcing, alpha);
+        if (safeguard > 0.1)
+            eta = std::max(eta, safeguard);
+    }
+    eta = std::max(eta, 0.5 * m_tol / error);
+    m_forcing = std::min(eta, eta_max);
+    return m_forcing;
+}
 
-    for (int i = 0; i < n; i++)
-        b[i] = rhs(i);
+// the step size grows after steps that converged in a few iterations with a small change
+// of the velocity, and it is halved when a step fails (see dynamic())
+void SolverImpl::adaptStepSize(const int niter, const VectorNodes& vel_prev, const VectorNodes& vel) {
+    const int    FAST_ITER  = 3;        // Newton iterations of a fast step
+    const double VEL_CHANGE = 0.1;      // relative velocity change of a smooth step
+    const double GROWTH     = 1.5;
 
+    if (niter > FAST_ITER || m_dt >= m_SimPar->dt_max())
+        return;
 
-    // int      nnz = ia[n];
-    int      mtype = -2;        /* Real symmetric matrix */
-    int      nrhs = 1;          /* Number of right hand sides. */
+    double dv = 0.0, v = 0.0;
+    for (int i = 0; i < m_SimGeo->nn(); i++) {
+        dv += (vel[i] - vel_prev[i]).squaredNorm();
+        v  += vel[i].squaredNorm();
+    }
+    if (dv > VEL_CHANGE * VEL_CHANGE * v)
+        return;
+    setStepSize(std::min(GROWTH * m_dt, m_SimPar->dt_max()));
+}
 
-    /* Internal solver memory pointer pt,                  */
-    /* 32-bit: int pt[64]; 64-bit: long int pt[64]         */
-    /* or void *pt[64] should be OK on both architectures  */ 
-    void    *pt[64]; 
+// the inertia terms of the jacobian depend on dt, a lagged factorization is discarded
+void SolverImpl::setStepSize(const double dt) {
+    m_dt = dt;
+    m_factorized = false;
+}
 
-    /* Pardiso control parameters. */
-    int      iparm[64];
-    double   dparm[64];
-    int      maxfct, mnum, phase, error, msglvl, solver;
+void SolverImpl::printNewtonStats() const {
+    if (EXPLICIT)
+        return;
+    if (RELAXATION) {
+        std::cout << "FIRE iterations: " << m_numIterations << std::endl;
+        return;
+    }
+    if (PROJECTIVE) {
+        std::cout << "projective dynamics global solves: " << m_numIterations << std::endl;
+        return;
+    }
+    std::cout << "Newton iterations: " << m_numIterations
+              << ", jacobian factorizations: " << m_numFactorizations << std::endl;
+    // iterations saved by a predictor: compare with the same run with predictor = 0
+    if (m_numSteps > 0)
+        std::cout << "Newton iterations per " << (DYNAMIC_SOLVER ? "step: " : "increment: ")
+                  << (double) m_numIterations / m_numSteps << " with predictor " << m_SimPar->predictor() << std::endl;
+    if (m_linearSolver->iterative())
+        std::cout << "linear solver iterations: " << m_linearSolver->iterations() << std::endl;
+}
 
-    /* Number of processors. */
-    int      num_procs;
+// find mapping vectors before the time loop starts
+void SolverImpl::findMappingVectors() {
+    m_fullToDofs.assign(m_numTotal, -1);
+    m_dofsToFull.clear();
+    m_dofsToFull.reserve(m_numNeumann);
+    for (int index = 0; index < m_numTotal; index++) {
+        if (!m_SimBC->inDirichletBC(index)) {
+            m_dofsToFull.push_back(index);
+            m_fullToDofs[index] = (int) (m_dofsToFull.size()-1);
+        }
+    }
+}
 
-    /* Auxiliary variables. */
-    char    *var;
-    int      i;
+// structured grid of the free dofs, used by the geometric multigrid solver
+void SolverImpl::findGrid() {
+    std::vector<int> gridDofs(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++) {
+        int node = m_dofsToFull[idof] / 3;
+        int dir  = m_dofsToFull[idof] % 3;
+        gridDofs[idof] = 3 * m_SimGeo->oldNode(node) + dir;
+    }
+    m_linearSolver->setGrid(m_SimGeo->num_nodes_len(), m_SimGeo->num_nodes_wid(), gridDofs);
+}
 
-    double   ddum;              /* Double dummy */
-    int      idum;              /* Integer dummy. */
+// build the sparsity pattern of the free dofs jacobian and the scatter maps of all stencils
+// NOTE: mesh connectivity doesn't change during the simulation, so this is only done once
+void SolverImpl::findSparsityPattern() {
+    SparseEntries entries_dof;
+    auto addStencil = [this, &entries_dof] (const int* nodes, const int nnode) {
+        for (int a = 0; a < nnode; a++) {
+            for (int b = 0; b < nnode; b++) {
+                for (int i = 0; i < 3; i++) {
+                    for (int j = 0; j < 3; j++) {
+                        int idof = m_fullToDofs[3*nodes[a] + i];
+                        int jdof = m_fullToDofs[3*nodes[b] + j];
+                        if (idof == -1 || jdof == -1)
+                            continue;
+                        // NOTE: only the upper triangular part of jacobian is stored, see LinearSolver
+                        if (idof > jdof)
+                            continue;
+                        entries_dof.emplace_back(Eigen::Triplet<double>(idof, jdof, 0.0));
+                    }
+                }
+            }
+        }
+    };
 
-   
-    /* -------------------------------------------------------------------- */
-    /* ..  Setup Pardiso control parameters.                                */
-    /* -------------------------------------------------------------------- */
-    error = 0;
-    solver = 0; /* use sparse direct solver */
-    pardisoinit (pt,  &mtype, &solver, iparm, dparm, &error); 
+    for (auto &iedge : m_SimGeo->m_edges)
+        addStencil(iedge.data(), 2);
+    for (auto &itri : m_SimGeo->m_triangles)
+        addStencil(itri.data(), 3);
+    for (auto &ihinge : m_SimGeo->m_hinges)
+        addStencil(ihinge.data(), 4);
+    // diagonal entries are always stored (inertia and viscous terms)
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        entries_dof.emplace_back(Eigen::Triplet<double>(idof, idof, 0.0));
+
+    m_jacobian.resize(m_numNeumann, m_numNeumann);
+    m_jacobian.setFromTriplets(entries_dof.begin(), entries_dof.end());
+    m_jacobian.makeCompressed();
+    SparseEntries().swap(entries_dof);
+
+    // scatter maps of all stencils
+    m_stretchMap.clear();
+    m_stretchMap.reserve(36 * m_SimGeo->m_edges.size());
+    for (auto &iedge : m_SimGeo->m_edges)
+        findScatterMap(iedge.data(), 2, m_stretchMap);
+    m_shearMap.clear();
+    m_shearMap.reserve(81 * m_SimGeo->m_triangles.size());
+    for (auto &itri : m_SimGeo->m_triangles)
+        findScatterMap(itri.data(), 3, m_shearMap);
+    m_bendMap.clear();
+    m_bendMap.reserve(144 * m_SimGeo->m_hinges.size());
+    for (auto &ihinge : m_SimGeo->m_hinges)
+        findScatterMap(ihinge.data(), 4, m_bendMap);
+    m_diagMap.resize(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        m_diagMap[idof] = findValueIndex(idof, idof);
+}
 
-    if (error != 0) 
-    {
-        if (error == -10 )
-           printf("No license file found \n");
-        if (error == -11 )
-           printf("License is expired \n");
-        if (error == -12 )
-           printf("Wrong username or hostname \n");
-        exit(1);
+// append the positions of a (3*nnode x 3*nnode) local jacobian, stored row by row
+void SolverImpl::findScatterMap(const int* nodes, const int nnode, std::vector<int>& map) {
+    for (int a = 0; a < nnode; a++) {
+        for (int i = 0; i < 3; i++) {
+            for (int b = 0; b < nnode; b++) {
+                for (int j = 0; j < 3; j++) {
+                    int idof = m_fullToDofs[3*nodes[a] + i];
+                    int jdof = m_fullToDofs[3*nodes[b] + j];
+                    if (idof == -1 || jdof == -1 || idof > jdof)
+                        map.push_back(-1);
+                    else
+                        map.push_back(findValueIndex(idof, jdof));
+                }
+            }
+        }
     }
-    
-    /* Numbers of processors, value of OMP_NUM_THREADS */
-    var = getenv("OMP_NUM_THREADS");
-    if(var != NULL)
-        sscanf( var, "%d", &num_procs );
-    else {
-        printf("Set environment OMP_NUM_THREADS to 1");
-        exit(1);
+}
+
+// position of entry (row, col) in the values of the compressed jacobian
+int SolverImpl::findValueIndex(const int row, const int col) const {
+    const int* first = m_jacobian.innerIndexPtr() + m_jacobian.outerIndexPtr()[row];
+    const int* last  = m_jacobian.innerIndexPtr() + m_jacobian.outerIndexPtr()[row+1];
+    const int* pos = std::lower_bound(first, last, col);
+    assert(pos != last && *pos == col);
+    return (int) (pos - m_jacobian.innerIndexPtr());
+}
+
+// stiffness coefficients of all stencils, they only depend on the rest state and the parameters
+void SolverImpl::findMaterialState() {
+    double E = m_SimPar->E_modulus();
+    double nu = m_SimPar->nu();
+    double thk = m_SimPar->thk();
+    double kbend = m_SimPar->kbend();
+    double G = E / (2.0 * (1.0 + nu));
+
+    m_ks.resize(m_SimGeo->m_edges.size());
+    for (int k = 0; k < m_ks.size(); k++)
+        m_ks(k) = E * thk / pow(m_SimGeo->m_len0[k], 2);
+
+    m_ksh.resize(m_SimGeo->m_triangles.size());
+    for (int k = 0; k < m_ksh.size(); k++)
+        m_ksh(k) = G * m_SimGeo->m_area[k] * thk;
+
+    m_kb.resize(m_SimGeo->m_hinges.size());
+    for (int k = 0; k < m_kb.size(); k++)
+        m_kb(k) = m_SimGeo->m_const[k] * kbend;
+
+    m_materialKey[0] = E;
+    m_materialKey[1] = nu;
+    m_materialKey[2] = thk;
+    m_materialKey[3] = kbend;
+}
+
+// true if the parameters differ from those of the current material state
+bool SolverImpl::materialChanged() const {
+    return (m_materialKey[0] != m_SimPar->E_modulus() || m_materialKey[1] != m_SimPar->nu() ||
+            m_materialKey[2] != m_SimPar->thk() || m_materialKey[3] != m_SimPar->kbend());
+}
+
+// group the stencils by colors for the multithreaded assembly
+// in serial mode all stencils have the same color and keep their original order
+void SolverImpl::findColoring() {
+    // the topology arrays are contiguous, nstencil x nnode node numbers
+    colorStencils(m_SimGeo->m_edges.data()->data(), m_SimGeo->m_edges.size(), 2,
+                  m_edgeOrder, m_edgeColorPtr);
+    colorStencils(m_SimGeo->m_triangles.data()->data(), m_SimGeo->m_triangles.size(), 3,
+                  m_elementOrder, m_elementColorPtr);
+    colorStencils(m_SimGeo->m_hinges.data()->data(), m_SimGeo->m_hinges.size(), 4,
+                  m_hingeOrder, m_hingeColorPtr);
+
+    std::cout << "active stencils: " << m_edgeOrder.size() << " edges, " << m_elementOrder.size()
+              << " elements, " << m_hingeOrder.size() << " hinges" << std::endl;
+    if (PARALLEL_ASSEMBLY) {
+        std::cout << "parallel assembly: " << m_edgeColorPtr.size()-1 << " edge colors, "
+                  << m_elementColorPtr.size()-1 << " element colors, "
+                  << m_hingeColorPtr.size()-1 << " hinge colors" << std::endl;
     }
-    iparm[2]  = num_procs;
+}
 
-    maxfct = 1;		/* Maximum number of numerical factorizations.  */
-    mnum   = 1;         /* Which factorization to use. */
-    
-    msglvl = 0;         /* Print statistical information  */
-    error  = 0;         /* Initialize error flag */
-
-    //* -------------------------------------------------------------------- */
-    /* ..  Reordering and Symbolic Factorization.  This step also allocates */
-    /*     all memory that is necessary for the factorization.              */
-    /* -------------------------------------------------------------------- */
-    phase = 11; 
-
-    pardiso (pt, &maxfct, &mnum, &mtype, &phase,
-	     &n, a, ia, ja, &idum, &nrhs,
-             iparm, &msglvl, &ddum, &ddum, &error, dparm);
-    
-    if (error != 0) {
-        printf("\nERROR during symbolic factorization: %d", error);
-        exit(1);
-    }
-   
-    /* -------------------------------------------------------------------- */
-    /* ..  Numerical factorization.                                         */
-    /* -------------------------------------------------------------------- */    
-    phase = 22;
-    iparm[32] = 1; /* compute determinant */
-
-    pardiso (pt, &maxfct, &mnum, &mtype, &phase,
-             &n, a, ia, ja, &idum, &nrhs,
-             iparm, &msglvl, &ddum, &ddum, &error,  dparm);
-   
-    if (error != 0) {
-        printf("\nERROR during numerical factorization: %d", error);
-        exit(2);
-    }
-
-    /* -------------------------------------------------------------------- */    
-    /* ..  Back substitution and iterative refinement.                      */
-    /* -------------------------------------------------------------------- */    
-    phase = 33;
-
-    iparm[7] = 1;       /* Max numbers of iterative refinement steps. */
-   
-    pardiso (pt, &maxfct, &mnum, &mtype, &phase,
-             &n, a, ia, ja, &idum, &nrhs,
-             iparm, &msglvl, b, x, &error,  dparm);
-   
-    if (error != 0) {
-        printf("\nERROR during solution: %d", error);
-        exit(3);
+// true if all dofs of the stencil are in Dirichlet BC, it adds nothing to the residual and the jacobian
+bool SolverImpl::stencilConstrained(const int* nodes, const int nnode) const {
+    for (int a = 0; a < nnode; a++) {
+        for (int i = 0; i < 3; i++) {
+            if (m_fullToDofs[3*nodes[a] + i] != -1)
+                return false;
+        }
     }
-    
-    for (i = 0; i < n; i++) {
-        u(i) = x[i];
+    return true;
+}
+
+// greedy coloring, a stencil takes the smallest color not used by any stencil sharing its nodes
+//   nodes: 0-based node numbers of all stencils (nstencil x nnode)
+// stencils that are fully constrained are left out, so the energy loops never visit them
+// NOTE: the coloring only depends on the mesh, so the summation order (and the result) of the
+//       multithreaded assembly is independent of the number of threads
+void SolverImpl::colorStencils(const int* nodes, const int nstencil, const int nnode,
+                               std::vector<int>& order, std::vector<int>& colorPtr) {
+    order.clear();
+    colorPtr.clear();
+
+    if (!PARALLEL_ASSEMBLY) {
+        for (int k = 0; k < nstencil; k++) {
+            if (!stencilConstrained(&nodes[nnode*k], nnode))
+                order.push_back(k);
+        }
+        colorPtr.push_back(0);
+        colorPtr.push_back((int) order.size());
+        return;
     }
 
-    /* -------------------------------------------------------------------- */    
-    /* ..  Termination and release of memory.                               */
-    /* -------------------------------------------------------------------- */    
-    phase = -1;                 /* Release internal memory. */
-    
-    pardiso (pt, &maxfct, &mnum, &mtype, &phase,
-             &n, &ddum, ia, ja, &idum, &nrhs,
-             iparm, &msglvl, &ddum, &ddum, &error,  dparm);
+    // colors used by the stencils around each node
+    std::vector<std::vector<int> > nodeColors(m_SimGeo->nn());
+    std::vector<int> stencilColor(nstencil, -1);
+    std::vector<bool> used;
+    int ncolor = 0;
+    for (int k = 0; k < nstencil; k++) {
+        if (stencilConstrained(&nodes[nnode*k], nnode))
+            continue;
+        used.assign(ncolor+1, false);
+        for (int a = 0; a < nnode; a++) {
+            for (int c : nodeColors[nodes[nnode*k+a]])
+                used[c] = true;
+        }
+        int color = 0;
+        while (used[color])
+            color++;
+        stencilColor[k] = color;
+        ncolor = std::max(ncolor, color+1);
+        for (int a = 0; a < nnode; a++)
+            nodeColors[nodes[nnode*k+a]].push_back(color);
+    }
+
+    // counting sort, stencils keep their original order inside each color
+    colorPtr.assign(ncolor+1, 0);
+    for (int k = 0; k < nstencil; k++) {
+        if (stencilColor[k] != -1)
+            colorPtr[stencilColor[k]+1]++;
+    }
+    for (int c = 0; c < ncolor; c++)
+        colorPtr[c+1] += colorPtr[c];
+    order.resize(colorPtr[ncolor]);
+    std::vector<int> pos(colorPtr.begin(), colorPtr.end()-1);
+    for (int k = 0; k < nstencil; k++) {
+        if (stencilColor[k] != -1)
+            order[pos[stencilColor[k]]++] = k;
+    }
+}
 
-    delete [] ia;
-    delete [] ja;
-    delete [] a;
-    delete [] x;
-    delete [] b;
+// stretch energy for each element
+void SolverImpl::DEStretch(VectorN& dEdq, double* jac) {
+    // loop over the edge list, color by color
+    for (int c = 0; c < m_edgeColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_edgeColorPtr[c]; p < m_edgeColorPtr[c+1]; p++)
+            DEStretchEdge(m_edgeOrder[p], dEdq, jac);
+    }
 }
 
-// ========================================= //
-//          Other helper functions           //
-// ========================================= //
+// shear energy for each element
+void SolverImpl::DEShear(VectorN& dEdq, double* jac) {
+    // loop over element list, color by color
+    for (int c = 0; c < m_elementColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_elementColorPtr[c]; p < m_elementColorPtr[c+1]; p++)
+            DEShearElement(m_elementOrder[p], dEdq, jac);
+    }
+}
 
-// find mapping vectors before the time loop starts
-void SolverImpl::findMappingVectors() {
-    m_fullToDofs.resize(m_numTotal, -1);
-    for (int index = 0; index < m_numTotal; index++) {
-        if (!m_SimBC->inDirichletBC(index)) {
-            m_dofsToFull.push_back(index);
-            m_fullToDofs[index] = (int) (m_dofsToFull.size()-1);
-        }
+// bending energy for each hinge
+void SolverImpl::DEBend(VectorN& dEdq, double* jac) {
+    const int LANES = BendingBatch::LANES;
+    // loop over the hinge list, color by color
+    for (int c = 0; c < m_hingeColorPtr.size()-1; c++) {
+        int first = m_hingeColorPtr[c];
+        int nbatch = (m_hingeColorPtr[c+1] - first) / LANES;
+
+        // vectorized batches of hinges
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int b = 0; b < nbatch; b++)
+            DEBendBatch(&m_hingeOrder[first + b*LANES], dEdq, jac);
+
+        // remaining hinges one by one
+        for (int p = first + nbatch*LANES; p < m_hingeColorPtr[c+1]; p++)
+            DEBendHinge(m_hingeOrder[p], dEdq, jac);
     }
 }
 
-// stretch energy for each element
-void SolverImpl::DEStretch(VectorN& dEdq, SparseEntries& entries_full) {
+// stretch energy of the k-th edge
+void SolverImpl::DEStretchEdge(const int k, VectorN& dEdq, double* jac) {
+    const Eigen::Vector2i& iedge = m_SimGeo->m_edges[k];
+    const VectorNodes& x = m_SimGeo->m_nodes;
 
-    // loop over the edge list
-    for (std::vector<Edge*>::iterator iedge = m_SimGeo->m_edgeList.begin(); iedge != m_SimGeo->m_edgeList.end(); iedge++) {
+    // local stretch force: fx1, fy1, fz1, fx2, fy2, fz2
+    Vector6d loc_f;
+    // local jacobian matrix
+    Matrix6d loc_j;
 
-        // local stretch force: fx1, fy1, fz1, fx2, fy2, fz2
-        Eigen::VectorXd loc_f = Eigen::VectorXd::Zero(6);
-        // local jacobian matrix
-        Eigen::MatrixXd loc_j = Eigen::MatrixXd::Zero(6, 6);
+    {
+        NoMallocScope noMalloc(!PARALLEL_ASSEMBLY);
+        Stretching EStretch(x[iedge[0]], x[iedge[1]], m_SimGeo->m_len0[k], m_ks(k));
+        if (jac == nullptr)
+            EStretch.locStretch(loc_f);
+        else
+            EStretch.locStretch(loc_f, loc_j);
+    }
 
-        Stretching EStretch(*iedge, m_SimPar->E_modulus(), m_SimPar->thk());
-        EStretch.locStretch(loc_f, loc_j);
+    // local node number corresponds to global node number
+    unsigned int nx1 = 3*iedge[0];
+    unsigned int nx2 = 3*iedge[1];
 
-        // TODO: combine these
-        // local node number corresponds to global node number
-        unsigned int n1 = (*iedge)->get_node_num(1);
-        unsigned int n2 = (*iedge)->get_node_num(2);
-        unsigned int nx1 = 3*(n1-1);
-        unsigned int nx2 = 3*(n2-1);
+    // stretching force
+    for (int p = 0; p < 3; p++) {
+        dEdq(nx1+p) += loc_f(p);
+        dEdq(nx2+p) += loc_f(p+3);
+    }
 
-        // stretching force
-        for (int p = 0; p < 3; p++) {
-            dEdq(nx1+p) += loc_f(p);
-            dEdq(nx2+p) += loc_f(p+3);
+    // stretching jacobian
+    if (jac == nullptr)
+        return;
+    const int* map = &m_stretchMap[36*k];
+    for (int i = 0; i < 6; i++) {
+        for (int j = 0; j < 6; j++) {
+            if (map[6*i+j] != -1)
+                jac[map[6*i+j]] += loc_j(i,j);
         }
+    }
+}
 
-        // stretching jacobian
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx1+j, loc_j(i,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx2+j, loc_j(i,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx1+j, loc_j(i+3,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx2+j, loc_j(i+3,j+3)));
-            }
+// shear energy of the k-th element
+void SolverImpl::DEShearElement(const int k, VectorN& dEdq, double* jac) {
+    const Eigen::Vector3i& iel = m_SimGeo->m_triangles[k];
+    const VectorNodes& x = m_SimGeo->m_nodes;
+
+    // local shearing force: fx1, fy1, fz1, fx2, fy2, fz2, fx3, fy3, fz3
+    Vector9d loc_f;
+    // local jacobian matrix
+    Matrix9d loc_j;
+
+    {
+        NoMallocScope noMalloc(!PARALLEL_ASSEMBLY);
+        Shearing EShear(x[iel[0]], x[iel[1]], x[iel[2]], m_SimGeo->m_phi0[k], m_ksh(k));
+        if (jac == nullptr)
+            EShear.locShear(loc_f);
+        else
+            EShear.locShear(loc_f, loc_j);
+    }
+
+    // local node number corresponds to global node number
+    unsigned int nx1 = 3*iel[0];
+    unsigned int nx2 = 3*iel[1];
+    unsigned int nx3 = 3*iel[2];
+
+    // shearing force
+    for (int p = 0; p < 3; p++) {
+        dEdq(nx1+p) += loc_f(p);
+        dEdq(nx2+p) += loc_f(p+3);
+        dEdq(nx3+p) += loc_f(p+6);
+    }
+
+    // shearing jacobian
+    if (jac == nullptr)
+        return;
+    const int* map = &m_shearMap[81*k];
+    for (int i = 0; i < 9; i++) {
+        for (int j = 0; j < 9; j++) {
+            if (map[9*i+j] != -1)
+                jac[map[9*i+j]] += loc_j(i,j);
         }
     }
 }
 
-// shear energy for each element
-void SolverImpl::DEShear(VectorN& dEdq, SparseEntries& entries_full) {
+// bending energy of the k-th hinge
+void SolverImpl::DEBendHinge(const int k, VectorN& dEdq, double* jac) {
+    const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+    const VectorNodes& x = m_SimGeo->m_nodes;
+
+    // local bending force: fx0, fy0, fz0, fx1, fy1, fz1, fx2, fy2, fz2, fx3, fy3, fz3
+    Vector12d loc_f;
+    // local jacobian matrix
+    Matrix12d loc_j;
+
+    // bending energy calculation
+    {
+        NoMallocScope noMalloc(!PARALLEL_ASSEMBLY);
+        Bending Ebend(x[ihinge[0]], x[ihinge[1]], x[ihinge[2]], x[ihinge[3]], m_kb(k), m_SimGeo->m_psi0[k]);
+        if (jac == nullptr)
+            Ebend.locBend(loc_f);
+        else
+            Ebend.locBend(loc_f, loc_j);
+    }
+
+    scatterBend(k, loc_f, loc_j, dEdq, jac);
+}
 
-    // loop over element list
-    for (std::vector<Element>::iterator iel = m_SimGeo->m_elementList.begin(); iel != m_SimGeo->m_elementList.end(); iel++) {
+// bending energy of LANES hinges at once
+void SolverImpl::DEBendBatch(const int* hinges, VectorN& dEdq, double* jac) {
+    BendingBatch Ebend;
+    Vector12d loc_f;
+    Matrix12d loc_j;
 
-        // local shearing force: fx1, fy1, fz1, fx2, fy2, fz2, fx3, fy3, fz3
-        Eigen::VectorXd loc_f = Eigen::VectorXd::Zero(9);
-        // local jacobian matrix
-        Eigen::MatrixXd loc_j = Eigen::MatrixXd::Zero(9, 9);
+    const VectorNodes& x = m_SimGeo->m_nodes;
 
-        Shearing EShear(&(*iel), m_SimPar->E_modulus(), m_SimPar->nu(), (*iel).get_area(), m_SimPar->thk());
-        EShear.locShear(loc_f, loc_j);
+    // gather hinge data into the lanes
+    for (int l = 0; l < BendingBatch::LANES; l++) {
+        const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[hinges[l]];
+        Ebend.setHinge(l, x[ihinge[0]], x[ihinge[1]], x[ihinge[2]], x[ihinge[3]],
+                       m_kb(hinges[l]), m_SimGeo->m_psi0[hinges[l]]);
+    }
+    {
+        NoMallocScope noMalloc(!PARALLEL_ASSEMBLY);
+        Ebend.compute(jac != nullptr);
+    }
 
-        // TODO: combine these
-        // local node number corresponds to global node number
-        unsigned int n1 = (*iel).get_node_num(1);
-        unsigned int n2 = (*iel).get_node_num(2);
-        unsigned int n3 = (*iel).get_node_num(3);
-        unsigned int nx1 = 3*(n1-1);
-        unsigned int nx2 = 3*(n2-1);
-        unsigned int nx3 = 3*(n3-1);
+    for (int l = 0; l < BendingBatch::LANES; l++) {
+        if (jac == nullptr)
+            Ebend.locBend(l, loc_f);
+        else
+            Ebend.locBend(l, loc_f, loc_j);
+        scatterBend(hinges[l], loc_f, loc_j, dEdq, jac);
+    }
+}
 
-        // shearing force
-        for (int p = 0; p < 3; p++) {
-            dEdq(nx1+p) += loc_f(p);
-            dEdq(nx2+p) += loc_f(p+3);
-            dEdq(nx3+p) += loc_f(p+6);
+// add local bending force and jacobian of the k-th hinge, loc_j is not used without jac
+void SolverImpl::scatterBend(const int k, const Vector12d& loc_f, const Matrix12d& loc_j, VectorN& dEdq, double* jac) {
+    const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+
+    // local node number corresponds to global node number
+    unsigned int nx0 = 3*ihinge[0];
+    unsigned int nx1 = 3*ihinge[1];
+    unsigned int nx2 = 3*ihinge[2];
+    unsigned int nx3 = 3*ihinge[3];
+
+    // bending force
+    for (int p = 0; p < 3; p++) {
+        dEdq(nx0+p) += loc_f(p);
+        dEdq(nx1+p) += loc_f(p+3);
+        dEdq(nx2+p) += loc_f(p+6);
+        dEdq(nx3+p) += loc_f(p+9);
+    }
+
+    // bending jacobian
+    if (jac == nullptr)
+        return;
+    const int* map = &m_bendMap[144*k];
+    for (int i = 0; i < 12; i++) {
+        for (int j = 0; j < 12; j++) {
+            if (map[12*i+j] != -1)
+                jac[map[12*i+j]] += loc_j(i,j);
         }
+    }
+}
 
-        // shearing jacobian
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx1+j, loc_j(i,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx2+j, loc_j(i,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx3+j, loc_j(i,j+6)));
-
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx1+j, loc_j(i+3,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx2+j, loc_j(i+3,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx3+j, loc_j(i+3,j+6)));
-
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx1+j, loc_j(i+6,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx2+j, loc_j(i+6,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx3+j, loc_j(i+6,j+6)));
+// ========================================= //
+//            Projective dynamics            //
+// ========================================= //
+
+//  Every stencil energy is replaced by w/2 * |A q - p|^2, where A q is a linear combination
+//  of the stencil nodes and p the closest point of A q on the rest state (local step):
+//    stretch: A q = x2 - x1,                             w = k_s,  |p| = l0
+//    shear:   A q = (x1 - x2, x3 - x2),                  w = 4 k_sh / (l1^2 + l2^2),  angle of p = phi0
+//    bend:    A q = sum c_i x_i, cotangent weights c_i,  w = k_b,  |p| = rest value of |A q|
+//  The weights match the second derivatives of the energies at the rest state. The global step
+//  solves (M / dt^2 + c / dt + sum w A^T A) q = M / dt^2 (q_n + dt v_n) + c / dt q_n + F_ext + sum w A^T p,
+//  its matrix is constant and factorized once.
+//
+void SolverImpl::findProjectiveSystem() {
+    const VectorNodes& x = m_SimGeo->m_nodes;
+    double dt = m_dt;
+    // viscous damping as in findResidual()
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+
+    // rest state of the shear and bending constraints, from the initial configuration
+    m_pdShearWeight.resize(m_SimGeo->m_triangles.size());
+    for (int k = 0; k < m_SimGeo->m_triangles.size(); k++) {
+        const Eigen::Vector3i& iel = m_SimGeo->m_triangles[k];
+        double l1 = (x[iel[0]] - x[iel[1]]).squaredNorm();
+        double l2 = (x[iel[2]] - x[iel[1]]).squaredNorm();
+        m_pdShearWeight(k) = 4.0 * m_ksh(k) / (l1 + l2);
+    }
+    m_pdBendCoeff.resize(m_SimGeo->m_hinges.size());
+    m_pdBendRest.resize(m_SimGeo->m_hinges.size());
+    for (int k = 0; k < m_SimGeo->m_hinges.size(); k++) {
+        const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+        Eigen::Vector3d e0 = x[ihinge[1]] - x[ihinge[0]];
+        Eigen::Vector3d e1 = x[ihinge[2]] - x[ihinge[0]];
+        Eigen::Vector3d e2 = x[ihinge[3]] - x[ihinge[0]];
+        Eigen::Vector3d e3 = x[ihinge[2]] - x[ihinge[1]];
+        Eigen::Vector3d e4 = x[ihinge[3]] - x[ihinge[1]];
+        auto cot = [] (const Eigen::Vector3d& a, const Eigen::Vector3d& b) {
+            return a.dot(b) / a.cross(b).norm();
+        };
+        double cot1 = cot(e0, e1), cot2 = cot(e0, e2), cot3 = cot(-e0, e3), cot4 = cot(-e0, e4);
+        double ne0 = e0.norm();
+        Eigen::Vector4d c((cot3 + cot4) / ne0, (cot1 + cot2) / ne0,
+                          -(cot1 + cot3) / ne0, -(cot2 + cot4) / ne0);
+        m_pdBendCoeff[k] = c;
+        Eigen::Vector3d v = c(0) * x[ihinge[0]] + c(1) * x[ihinge[1]] + c(2) * x[ihinge[2]] + c(3) * x[ihinge[3]];
+        m_pdBendRest(k) = v.norm();
+    }
+
+    // w * a a^T of every constraint, the columns of Dirichlet dofs go to the right hand side
+    SparseEntries entries;
+    m_pdFixed = VectorN::Zero(m_numNeumann);
+    auto addConstraint = [this, &entries, &x] (const int* nodes, const double* a, const int nnode, const double w) {
+        for (int p = 0; p < nnode; p++) {
+            for (int q = 0; q < nnode; q++) {
+                for (int dir = 0; dir < 3; dir++) {
+                    int idof = m_fullToDofs[3*nodes[p] + dir];
+                    int jdof = m_fullToDofs[3*nodes[q] + dir];
+                    if (idof == -1)
+                        continue;
+                    if (jdof == -1)
+                        m_pdFixed(idof) -= w * a[p] * a[q] * x[nodes[q]][dir];
+                    // NOTE: only the upper triangular part is stored, see LinearSolver
+                    else if (idof <= jdof)
+                        entries.emplace_back(idof, jdof, w * a[p] * a[q]);
+                }
             }
         }
+    };
+    const double aStretch[2] = {-1.0, 1.0};
+    const double aShear1[3] = {1.0, -1.0, 0.0};
+    const double aShear2[3] = {0.0, -1.0, 1.0};
+    for (int k = 0; k < m_SimGeo->m_edges.size(); k++)
+        addConstraint(m_SimGeo->m_edges[k].data(), aStretch, 2, m_ks(k));
+    for (int k = 0; k < m_SimGeo->m_triangles.size(); k++) {
+        addConstraint(m_SimGeo->m_triangles[k].data(), aShear1, 3, m_pdShearWeight(k));
+        addConstraint(m_SimGeo->m_triangles[k].data(), aShear2, 3, m_pdShearWeight(k));
     }
+    for (int k = 0; k < m_SimGeo->m_hinges.size(); k++)
+        addConstraint(m_SimGeo->m_hinges[k].data(), m_pdBendCoeff[k].data(), 4, m_kb(k));
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        entries.emplace_back(idof, idof, m_SimGeo->m_mass(m_dofsToFull[idof]) / (dt*dt) + nu * area / dt);
+
+    // the linear solver keeps a pointer to the matrix, it lives as long as the factorization
+    m_pdSystem.resize(m_numNeumann, m_numNeumann);
+    m_pdSystem.setFromTriplets(entries.begin(), entries.end());
+    m_pdSystem.makeCompressed();
+
+    m_linearSolver->compute(m_pdSystem);
+    m_numFactorizations++;
 }
 
-void SolverImpl::DEBend(VectorN& dEdq, SparseEntries& entries_full) {
+// local step: project every constraint, add w * A^T p to the right hand side
+// stencils of the same color don't share any node, they are projected in parallel
+void SolverImpl::projectConstraints(VectorN& rhs) const {
+    const VectorNodes& x = m_SimGeo->m_nodes;
+
+    for (int c = 0; c < m_edgeColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_edgeColorPtr[c]; p < m_edgeColorPtr[c+1]; p++) {
+            int k = m_edgeOrder[p];
+            const Eigen::Vector2i& iedge = m_SimGeo->m_edges[k];
+            Eigen::Vector3d e = x[iedge[1]] - x[iedge[0]];
+            Eigen::Vector3d proj = m_ks(k) * m_SimGeo->m_len0[k] * e.normalized();
+            rhs.segment<3>(3*iedge[0]) -= proj;
+            rhs.segment<3>(3*iedge[1]) += proj;
+        }
+    }
 
-    // loop over the hinge list
-    for (std::vector<Hinge*>::iterator ihinge = m_SimGeo->m_hingeList.begin(); ihinge != m_SimGeo->m_hingeList.end(); ihinge++) {
+    for (int c = 0; c < m_elementColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_elementColorPtr[c]; p < m_elementColorPtr[c+1]; p++) {
+            int k = m_elementOrder[p];
+            const Eigen::Vector3i& iel = m_SimGeo->m_triangles[k];
+            Eigen::Vector3d e1 = x[iel[0]] - x[iel[1]];
+            Eigen::Vector3d e2 = x[iel[2]] - x[iel[1]];
+            // rotate both edges about their bisector, in their plane, to the rest angle
+            Eigen::Vector3d u1 = e1.normalized();
+            Eigen::Vector3d u2 = e2.normalized();
+            Eigen::Vector3d b = (u1 + u2).normalized();
+            Eigen::Vector3d t = (u1 - u2).normalized();
+            double half = 0.5 * m_SimGeo->m_phi0[k];
+            Eigen::Vector3d p1 = e1.norm() * (cos(half) * b + sin(half) * t);
+            Eigen::Vector3d p2 = e2.norm() * (cos(half) * b - sin(half) * t);
+            double w = m_pdShearWeight(k);
+            rhs.segment<3>(3*iel[0]) += w * p1;
+            rhs.segment<3>(3*iel[1]) -= w * (p1 + p2);
+            rhs.segment<3>(3*iel[2]) += w * p2;
+        }
+    }
 
-        // local bending force: fx0, fy0, fz0, fx1, fy1, fz1, fx2, fy2, fz2, fx3, fy3, fz3
-        Eigen::VectorXd loc_f = Eigen::VectorXd::Zero(12);
-        // local jacobian matrix
-        Eigen::MatrixXd loc_j = Eigen::MatrixXd::Zero(12, 12);
+    for (int c = 0; c < m_hingeColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_hingeColorPtr[c]; p < m_hingeColorPtr[c+1]; p++) {
+            int k = m_hingeOrder[p];
+            const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+            const Eigen::Vector4d& coeff = m_pdBendCoeff[k];
+            // flat rest state: the projection is zero
+            if (m_pdBendRest(k) == 0.0)
+                continue;
+            Eigen::Vector3d v = Eigen::Vector3d::Zero();
+            for (int a = 0; a < 4; a++)
+                v += coeff(a) * x[ihinge[a]];
+            Eigen::Vector3d proj = m_kb(k) * m_pdBendRest(k) * v.normalized();
+            for (int a = 0; a < 4; a++)
+                rhs.segment<3>(3*ihinge[a]) += coeff(a) * proj;
+        }
+    }
+}
 
-        // coefficients k for gradient and hessian
-        (*ihinge)->m_k = (*ihinge)->m_const * m_SimPar->kbend();
+// one time step of projective dynamics, pd_iter local/global iterations from the inertial prediction
+void SolverImpl::projectiveStep(VectorNodes& x, VectorNodes& vel) {
+    double dt = m_dt;
+    // viscous damping as in findResidual()
+    double nu = m_SimPar->vis();
+    double area = 0.5 * m_SimGeo->rec_len() * m_SimGeo->rec_wid()
+                  / (m_SimGeo->num_nodes_len() * m_SimGeo->num_nodes_wid());
+
+    VectorNodes x_n = x;
+    VectorN inertia(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++) {
+        int pos = m_dofsToFull[idof];
+        int i = pos / 3, j = pos % 3;
+        double m = m_SimGeo->m_mass(pos);
+        inertia(idof) = m / (dt*dt) * (x_n[i][j] + dt * vel[i][j]) + nu * area / dt * x_n[i][j]
+                        + m_SimBC->m_fext(pos) + m_pdFixed(idof);
+        x[i][j] = x_n[i][j] + dt * vel[i][j];
+    }
+
+    VectorN rhs_full(m_numTotal);
+    VectorN rhs(m_numNeumann);
+    VectorN q(m_numNeumann);
+    for (int iter = 0; iter < m_SimPar->pd_iter(); iter++) {
+        rhs_full.setZero();
+        projectConstraints(rhs_full);
+        for (int idof = 0; idof < m_numNeumann; idof++)
+            rhs(idof) = inertia(idof) + rhs_full(m_dofsToFull[idof]);
+
+        m_linearSolver->solve(rhs, q);
+        m_numIterations++;
+        for (int idof = 0; idof < m_numNeumann; idof++)
+            x[m_dofsToFull[idof] / 3][m_dofsToFull[idof] % 3] = q(idof);
+    }
 
-        // bending energy calculation
-        Bending Ebend(*ihinge);
-        Ebend.locBend(loc_f, loc_j);
+    for (int i = 0; i < m_SimGeo->nn(); i++)
+        vel[i] = (x[i] - x_n[i]) / dt;
+}
+
+// ========================================= //
+//            Matrix-free jacobian           //
+// ========================================= //
 
-        // TODO: combine these
-        // local node number corresponds to global node number
-        unsigned int n0 = (*ihinge)->get_node_num(0);
-        unsigned int n1 = (*ihinge)->get_node_num(1);
-        unsigned int n2 = (*ihinge)->get_node_num(2);
-        unsigned int n3 = (*ihinge)->get_node_num(3);
-        unsigned int nx0 = 3*(n0-1);
-        unsigned int nx1 = 3*(n1-1);
-        unsigned int nx2 = 3*(n2-1);
-        unsigned int nx3 = 3*(n3-1);
+// call func(nodes, loc_j) with the local jacobian of every stencil of the current configuration
+// stencils are visited color by color, so func may add to nodal quantities in parallel
+template <typename Func>
+void SolverImpl::forEachLocalJacobian(Func func) const {
+    const VectorNodes& x = m_SimGeo->m_nodes;
+
+    for (int c = 0; c < m_edgeColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_edgeColorPtr[c]; p < m_edgeColorPtr[c+1]; p++) {
+            int k = m_edgeOrder[p];
+            const Eigen::Vector2i& iedge = m_SimGeo->m_edges[k];
+            Vector6d loc_f;
+            Matrix6d loc_j;
+            Stretching EStretch(x[iedge[0]], x[iedge[1]], m_SimGeo->m_len0[k], m_ks(k));
+            EStretch.locStretch(loc_f, loc_j);
+            func(iedge.data(), loc_j);
+        }
+    }
 
-        // bending force
-        for (int p = 0; p < 3; p++) {
-            dEdq(nx0+p) += loc_f(p);
-            dEdq(nx1+p) += loc_f(p+3);
-            dEdq(nx2+p) += loc_f(p+6);
-            dEdq(nx3+p) += loc_f(p+9);
+    for (int c = 0; c < m_elementColorPtr.size()-1; c++) {
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int p = m_elementColorPtr[c]; p < m_elementColorPtr[c+1]; p++) {
+            int k = m_elementOrder[p];
+            const Eigen::Vector3i& iel = m_SimGeo->m_triangles[k];
+            Vector9d loc_f;
+            Matrix9d loc_j;
+            Shearing EShear(x[iel[0]], x[iel[1]], x[iel[2]], m_SimGeo->m_phi0[k], m_ksh(k));
+            EShear.locShear(loc_f, loc_j);
+            func(iel.data(), loc_j);
         }
+    }
 
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                entries_full.emplace_back(Eigen::Triplet<double>(nx0+i, nx0+j, loc_j(i,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx0+i, nx1+j, loc_j(i,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx0+i, nx2+j, loc_j(i,j+6)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx0+i, nx3+j, loc_j(i,j+9)));
-
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx0+j, loc_j(i+3,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx1+j, loc_j(i+3,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx2+j, loc_j(i+3,j+6)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx1+i, nx3+j, loc_j(i+3,j+9)));
-
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx0+j, loc_j(i+6,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx1+j, loc_j(i+6,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx2+j, loc_j(i+6,j+6)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx2+i, nx3+j, loc_j(i+6,j+9)));
-
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx0+j, loc_j(i+9,j)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx1+j, loc_j(i+9,j+3)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx2+j, loc_j(i+9,j+6)));
-                entries_full.emplace_back(Eigen::Triplet<double>(nx3+i, nx3+j, loc_j(i+9,j+9)));
+    const int LANES = BendingBatch::LANES;
+    for (int c = 0; c < m_hingeColorPtr.size()-1; c++) {
+        int first = m_hingeColorPtr[c];
+        int last  = m_hingeColorPtr[c+1];
+        int nbatch = (last - first + LANES - 1) / LANES;
+
+        #pragma omp parallel for schedule(static) if (PARALLEL_ASSEMBLY)
+        for (int b = 0; b < nbatch; b++) {
+            const int* hinges = &m_hingeOrder[first + b*LANES];
+            int nlane = std::min(LANES, last - first - b*LANES);
+
+            // unused lanes of the last batch repeat its first hinge
+            BendingBatch Ebend;
+            for (int l = 0; l < LANES; l++) {
+                int k = hinges[l < nlane ? l : 0];
+                const Eigen::Vector4i& ihinge = m_SimGeo->m_hinges[k];
+                Ebend.setHinge(l, x[ihinge[0]], x[ihinge[1]], x[ihinge[2]], x[ihinge[3]],
+                               m_kb(k), m_SimGeo->m_psi0[k]);
+            }
+            Ebend.compute();
+
+            Vector12d loc_f;
+            Matrix12d loc_j;
+            for (int l = 0; l < nlane; l++) {
+                Ebend.locBend(l, loc_f, loc_j);
+                func(m_SimGeo->m_hinges[hinges[l]].data(), loc_j);
             }
         }
     }
-}
\ No newline at end of file
+}
+
+// diagonal of the jacobian of the free dofs, Jacobi preconditioner of the matrix-free solver
+void SolverImpl::findJacobianDiagonal(VectorN& diag) const {
+    VectorN diag_full = VectorN::Zero(m_numTotal);
+    forEachLocalJacobian([&diag_full] (const int* nodes, const auto& loc_j) {
+        for (int i = 0; i < loc_j.rows(); i++)
+            diag_full(3*nodes[i/3] + i%3) += loc_j(i,i);
+    });
+
+    diag.resize(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        diag(idof) = diag_full(m_dofsToFull[idof]) + findDiagonalTerm(idof);
+}
+
+// stable step size of the explicit integrator, 2 / omega_max, where omega_max^2 is bounded by
+// the largest Gershgorin row sum of M^-1 * K of the free dofs at the initial configuration
+double SolverImpl::findStableStep() const {
+    const double SAFETY = 0.9;      // margin for the stiffening of the deformed configuration
+
+    VectorN rowsum;
+    findStiffnessRowSums(rowsum);
+
+    double omega2 = 0.0;
+    for (int idof = 0; idof < m_numNeumann; idof++) {
+        int pos = m_dofsToFull[idof];
+        omega2 = std::max(omega2, rowsum(pos) / m_SimGeo->m_mass(pos));
+    }
+    if (omega2 == 0.0)
+        throw "cannot estimate the stable step size, the stiffness is zero";
+    return SAFETY * 2.0 / sqrt(omega2);
+}
+
+// sum_j |K_ij| of the stiffness of the current configuration, all dofs
+void SolverImpl::findStiffnessRowSums(VectorN& rowsum) const {
+    rowsum = VectorN::Zero(m_numTotal);
+    forEachLocalJacobian([&rowsum] (const int* nodes, const auto& loc_j) {
+        for (int i = 0; i < loc_j.rows(); i++)
+            rowsum(3*nodes[i/3] + i%3) += loc_j.row(i).cwiseAbs().sum();
+    });
+}
+
+// Jv = J * v on the free dofs, Dirichlet dofs have no motion
+void SolverImpl::multiplyJacobian(const VectorN& v, VectorN& Jv) const {
+    VectorN v_full = VectorN::Zero(m_numTotal);
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        v_full(m_dofsToFull[idof]) = v(idof);
+
+    VectorN Jv_full = VectorN::Zero(m_numTotal);
+    forEachLocalJacobian([&v_full, &Jv_full] (const int* nodes, const auto& loc_j) {
+        constexpr int n = std::decay_t<decltype(loc_j)>::RowsAtCompileTime;
+        Eigen::Matrix<double, n, 1> loc_v, loc_Jv;
+        for (int a = 0; a < n/3; a++)
+            loc_v.template segment<3>(3*a) = v_full.segment<3>(3*nodes[a]);
+        loc_Jv.noalias() = loc_j * loc_v;
+        for (int a = 0; a < n/3; a++)
+            Jv_full.segment<3>(3*nodes[a]) += loc_Jv.template segment<3>(3*a);
+    });
+
+    Jv.resize(m_numNeumann);
+    for (int idof = 0; idof < m_numNeumann; idof++)
+        Jv(idof) = Jv_full(m_dofsToFull[idof]) + findDiagonalTerm(idof) * v(idof);
+}
+
+void JacobianOperator::multiply(const VectorN& v, VectorN& Jv) const {
+    m_solver->multiplyJacobian(v, Jv);
+}
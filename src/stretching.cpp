@@ -1,7 +1,5 @@
 #include <cmath>
 #include "stretching.h"
-#include "edge.h"
-#include "node.h"
 
 /*
  *     x1                x2
@@ -11,22 +9,18 @@
 
 // -----------------------------------------------------------------------
 
-Stretching::Stretching(Edge* ptr, double E, double T) {
-    m_edge = ptr;
-
-    m_ne0 = *(m_edge->get_node(2)->get_xyz()) - *(m_edge->get_node(1)->get_xyz());
+Stretching::Stretching(const Eigen::Vector3d& x1, const Eigen::Vector3d& x2, double len0, double ks)
+    : m_len0(len0), m_ks(ks)
+{
+    m_ne0 = x2 - x1;
     m_len = m_ne0.norm();
     m_ne0 = m_ne0 / m_len;
-
-    // // FIXME: implement inextensible cloth, remove *100
-    // m_ks = E * M_PI/4.0 * pow(D, 2) / m_len * 100;
-    m_ks = E * T / pow(m_len, 2);
 }
 
 // -----------------------------------------------------------------------
-void Stretching::locStretch(Eigen::VectorXd& loc_f, Eigen::MatrixXd& loc_j) {
-    Eigen::VectorXd gradLen = Eigen::VectorXd::Zero(6);
-    Eigen::MatrixXd hessLen = Eigen::MatrixXd::Zero(6, 6);
+void Stretching::locStretch(Vector6d& loc_f, Matrix6d& loc_j) {
+    Vector6d gradLen;
+    Matrix6d hessLen;
 
     grad(gradLen);
     hess(hessLen);
@@ -35,23 +29,30 @@ void Stretching::locStretch(Eigen::VectorXd& loc_f, Eigen::MatrixXd& loc_j) {
     loc_j = m_ks * hessLen;
 }
 
+// force only, for the explicit integrator
+void Stretching::locStretch(Vector6d& loc_f) {
+    Vector6d gradLen;
+    grad(gradLen);
+    loc_f = m_ks * gradLen;
+}
+
 // -----------------------------------------------------------------------
 
-void Stretching::grad(Eigen::VectorXd& gradLen) {
-    double deltaLen = m_len - m_edge->get_len0();
-    gradLen.segment(0, 3) = - deltaLen * m_ne0;
-    gradLen.segment(3, 3) = deltaLen * m_ne0;
+void Stretching::grad(Vector6d& gradLen) {
+    double deltaLen = m_len - m_len0;
+    gradLen.segment<3>(0) = - deltaLen * m_ne0;
+    gradLen.segment<3>(3) = deltaLen * m_ne0;
 }
 
-void Stretching::hess(Eigen::MatrixXd& hessLen) {
-    double deltaRatio = 1 - m_edge->get_len0() / m_len;
+void Stretching::hess(Matrix6d& hessLen) {
+    double deltaRatio = 1 - m_len0 / m_len;
     Eigen::Matrix3d dyadicMat = m_ne0 * m_ne0.transpose();
     Eigen::Matrix3d id3 = Eigen::Matrix3d::Identity(3,3);
 
-    hessLen.block(0,0, 3,3) = dyadicMat + deltaRatio * (id3 - dyadicMat.transpose());
-    hessLen.block(0,3, 3,3) = - hessLen.block(0,0, 3,3);
-    hessLen.block(3,3, 3,3) = hessLen.block(0,0, 3,3);
+    hessLen.block<3,3>(0,0) = dyadicMat + deltaRatio * (id3 - dyadicMat.transpose());
+    hessLen.block<3,3>(0,3) = - hessLen.block<3,3>(0,0);
+    hessLen.block<3,3>(3,3) = hessLen.block<3,3>(0,0);
 
     // symmetric matrix
-    hessLen.block(3,0, 3,3) = hessLen.block(0,3, 3,3);
+    hessLen.block<3,3>(3,0) = hessLen.block<3,3>(0,3);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "trajectory_codec.h"
+
+namespace {
+
+    int64_t predict(const std::vector<int64_t>& q1, const std::vector<int64_t>& q2, const int order, const size_t i) {
+        if (order == 0)
+            return 0;
+        if (order == 1)
+            return q1[i];
+        return 2 * q1[i] - q2[i];
+    }
+
+}
+
+void TrajectoryCodec::encodeFrame(const std::vector<int64_t>& q, const std::vector<int64_t>& q1,
+                                  const std::vector<int64_t>& q2, const int order, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    for (size_t i = 0; i < q.size(); i++) {
+        int64_t r = q[i] - predict(q1, q2, order, i);
+        // zigzag: small residuals of both signs become small unsigned numbers
+        uint64_t u = ((uint64_t) r << 1) ^ (uint64_t) (r >> 63);
+        while (u >= 0x80) {
+            bytes.push_back((uint8_t) (u | 0x80));
+            u >>= 7;
+        }
+        bytes.push_back((uint8_t) u);
+    }
+}
+
+void TrajectoryCodec::decodeFrame(const uint8_t* bytes, const size_t nbytes, const std::vector<int64_t>& q1,
+                                  const std::vector<int64_t>& q2, const int order, std::vector<int64_t>& q) {
+    size_t pos = 0;
+    for (size_t i = 0; i < q.size(); i++) {
+        uint64_t u = 0;
+        int shift = 0;
+        while (true) {
+            if (pos >= nbytes || shift > 63)
+                throw "corrupted frame of the compressed trajectory";
+            uint8_t b = bytes[pos++];
+            u |= (uint64_t) (b & 0x7f) << shift;
+            shift += 7;
+            if (b < 0x80)
+                break;
+        }
+        int64_t r = (int64_t) (u >> 1) ^ -(int64_t) (u & 1);
+        q[i] = r + predict(q1, q2, order, i);
+    }
+    if (pos != nbytes)
+        throw "corrupted frame of the compressed trajectory";
+}
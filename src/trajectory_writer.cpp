@@ -0,0 +1,68 @@
+#include <cstring>
+#include <unistd.h>
+
+#include "trajectory_writer.h"
+#include "geometry.h"
+
+// resume: size of the file at the checkpoint of a restart, 0 - new file
+TrajectoryWriter::TrajectoryWriter(const std::string& filename, const Geometry* SimGeo, const bool single, const long resume)
+    : m_SimGeo(SimGeo), m_single(single), m_bytes(resume)
+{
+    if (resume > 0) {
+        if (truncate(filename.c_str(), resume) != 0)
+            throw "cannot continue the trajectory file of the checkpoint";
+        m_file.open(filename.c_str(), std::ios::binary | std::ios::app);
+        if (!m_file)
+            throw "cannot open the trajectory file";
+        return;
+    }
+
+    m_file.open(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file)
+        throw "cannot open the trajectory file";
+
+    std::vector<int32_t> header = {(int32_t) m_SimGeo->nn(), (int32_t) m_SimGeo->nel(),
+                                   (int32_t) m_SimGeo->nen(), m_single ? 4 : 8};
+    for (int i = 0; i < m_SimGeo->nel(); i++) {
+        for (int j = 0; j < m_SimGeo->nen(); j++)
+            header.push_back(m_SimGeo->m_mesh[i][j]);
+    }
+    // frames start at a multiple of 8 bytes
+    if (header.size() % 2 != 0)
+        header.push_back(0);
+
+    const char magic[8] = {'P', 'S', 'T', 'R', 'A', 'J', '0', '1'};
+    m_file.write(magic, sizeof(magic));
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size() * sizeof(int32_t));
+    m_file.flush();
+    m_bytes = sizeof(magic) + header.size() * sizeof(int32_t);
+}
+
+// the frame is flushed, a running simulation can be post-processed
+void TrajectoryWriter::writeFrame(const int ist, const VectorNodes& nodes) {
+    if (m_single)
+        packFrame<float>(ist, nodes);
+    else
+        packFrame<double>(ist, nodes);
+    m_file.write(m_buffer.data(), m_buffer.size());
+    m_file.flush();
+    if (!m_file)
+        throw "writing the trajectory file failed";
+    m_bytes += m_buffer.size();
+}
+
+template <typename Real>
+void TrajectoryWriter::packFrame(const int ist, const VectorNodes& nodes) {
+    int nn = m_SimGeo->nn();
+    m_buffer.resize(sizeof(int64_t) + 3 * nn * sizeof(Real));
+
+    int64_t step = ist;
+    std::memcpy(m_buffer.data(), &step, sizeof(int64_t));
+    Real* coord = reinterpret_cast<Real*>(m_buffer.data() + sizeof(int64_t));
+    // nodes in the original numbering
+    for (int k = 0; k < nn; k++) {
+        const Eigen::Vector3d& node = nodes[m_SimGeo->newNode(k)];
+        for (int j = 0; j < 3; j++)
+            coord[3*k + j] = (Real) node[j];
+    }
+}
@@ -0,0 +1,170 @@
+#include <cstring>
+#include <iomanip>
+#include <unistd.h>
+
+#include "xdmf_writer.h"
+#include "geometry.h"
+
+// frame header: int64 step, float64 time
+static const long HEADER = sizeof(int64_t) + sizeof(double);
+static const char* TAIL = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+// resume: size of trajectory.raw at the checkpoint of a restart, 0 - new files
+XdmfWriter::XdmfWriter(const std::string& path, const Geometry* SimGeo, const bool single, const int fields,
+                       const long resume)
+    : m_SimGeo(SimGeo), m_single(single), m_fields(fields), m_bytes(resume)
+{
+    if (m_SimGeo->nen() != 3)
+        throw "the XDMF export requires triangular elements";
+    if (fields < 0 || fields > 15)
+        throw "out_fields must be between 0 and 15";
+    int nn = m_SimGeo->nn();
+    m_frameBytes = HEADER + (3 * nn + fieldSize(fields, nn, m_SimGeo->nel())) * (m_single ? 4 : 8);
+
+    // the connectivity is written once
+    std::vector<int32_t> conn;
+    for (int i = 0; i < m_SimGeo->nel(); i++) {
+        for (int j = 0; j < 3; j++)
+            conn.push_back(m_SimGeo->m_mesh[i][j] - 1);
+    }
+    std::ofstream topology((path + "topology.bin").c_str(), std::ios::binary | std::ios::trunc);
+    topology.write(reinterpret_cast<const char*>(conn.data()), conn.size() * sizeof(int32_t));
+    if (!topology)
+        throw "writing the XDMF topology failed";
+
+    std::string rawname = path + "trajectory.raw";
+    std::vector<int64_t> steps;
+    std::vector<double> times;
+    if (resume > 0) {
+        if (resume % m_frameBytes != 0)
+            throw "cannot continue the trajectory file of the checkpoint";
+        std::ifstream raw(rawname.c_str(), std::ios::binary);
+        steps.resize(resume / m_frameBytes);
+        times.resize(steps.size());
+        for (int f = 0; f < steps.size(); f++) {
+            raw.seekg(f * m_frameBytes);
+            raw.read(reinterpret_cast<char*>(&steps[f]), sizeof(int64_t));
+            raw.read(reinterpret_cast<char*>(&times[f]), sizeof(double));
+        }
+        if (!raw || truncate(rawname.c_str(), resume) != 0)
+            throw "cannot continue the trajectory file of the checkpoint";
+        m_raw.open(rawname.c_str(), std::ios::binary | std::ios::app);
+    }
+    else
+        m_raw.open(rawname.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_raw)
+        throw "cannot open the trajectory file";
+
+    m_xml.open((path + "trajectory.xmf").c_str(), std::ios::trunc);
+    if (!m_xml)
+        throw "cannot open the XDMF file";
+    m_xml << std::setprecision(15);
+    m_xml << "<?xml version=\"1.0\" ?>\n"
+          << "<Xdmf Version=\"3.0\">\n"
+          << "  <Domain>\n"
+          << "    <Grid Name=\"trajectory\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+    m_tail = m_xml.tellp();
+    for (int f = 0; f < steps.size(); f++)
+        writeGrid((int) steps[f], times[f], f * m_frameBytes);
+    m_xml << TAIL;
+    m_xml.flush();
+}
+
+int XdmfWriter::fieldSize(const int fields, const int nn, const int nel) {
+    int size = 0;
+    if (fields & VELOCITY)
+        size += 3 * nn;
+    if (fields & FORCE)
+        size += 3 * nn;
+    if (fields & STRAIN)
+        size += nel;
+    if (fields & BENDING)
+        size += nel;
+    return size;
+}
+
+// fields: values of the selected fields in the order of the header, see fieldSize()
+void XdmfWriter::writeFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields) {
+    if (fields.size() != fieldSize(m_fields, m_SimGeo->nn(), m_SimGeo->nel()))
+        throw "the output fields do not match out_fields";
+    if (m_single)
+        packFrame<float>(ist, time, nodes, fields);
+    else
+        packFrame<double>(ist, time, nodes, fields);
+    m_raw.write(m_buffer.data(), m_buffer.size());
+    m_raw.flush();
+    if (!m_raw)
+        throw "writing the trajectory file failed";
+
+    // the closing tags are overwritten by the new frame
+    m_xml.seekp(m_tail);
+    writeGrid(ist, time, m_bytes);
+    m_xml << TAIL;
+    m_xml.flush();
+    if (!m_xml)
+        throw "writing the XDMF file failed";
+    m_bytes += m_buffer.size();
+}
+
+template <typename Real>
+void XdmfWriter::packFrame(const int ist, const double time, const VectorNodes& nodes, const VectorN& fields) {
+    int nn = m_SimGeo->nn();
+    m_buffer.resize(m_frameBytes);
+
+    int64_t step = ist;
+    std::memcpy(m_buffer.data(), &step, sizeof(int64_t));
+    std::memcpy(m_buffer.data() + sizeof(int64_t), &time, sizeof(double));
+    Real* values = reinterpret_cast<Real*>(m_buffer.data() + HEADER);
+    // nodes in the original numbering
+    for (int k = 0; k < nn; k++) {
+        const Eigen::Vector3d& node = nodes[m_SimGeo->newNode(k)];
+        for (int j = 0; j < 3; j++)
+            values[3*k + j] = (Real) node[j];
+    }
+    values += 3 * nn;
+    for (int i = 0; i < fields.size(); i++)
+        values[i] = (Real) fields(i);
+}
+
+// grid of the frame at offset in trajectory.raw
+void XdmfWriter::writeGrid(const int ist, const double time, const long offset) {
+    int nn = m_SimGeo->nn();
+    int nel = m_SimGeo->nel();
+    int precision = m_single ? 4 : 8;
+    long seek = offset + HEADER;
+
+    auto dataItem = [this, precision, &seek] (const int rows, const int cols) {
+        m_xml << "          <DataItem Dimensions=\"" << rows;
+        if (cols > 1)
+            m_xml << " " << cols;
+        m_xml << "\" NumberType=\"Float\" Precision=\"" << precision << "\" Format=\"Binary\" Seek=\"" << seek
+              << "\">trajectory.raw</DataItem>\n";
+        seek += (long) rows * cols * precision;
+    };
+    auto attribute = [this, &dataItem] (const char* name, const bool node, const int rows, const int cols) {
+        m_xml << "        <Attribute Name=\"" << name << "\" AttributeType=\"" << (cols > 1 ? "Vector" : "Scalar")
+              << "\" Center=\"" << (node ? "Node" : "Cell") << "\">\n";
+        dataItem(rows, cols);
+        m_xml << "        </Attribute>\n";
+    };
+
+    m_xml << "      <Grid Name=\"step " << ist << "\" GridType=\"Uniform\">\n"
+          << "        <Time Value=\"" << time << "\"/>\n"
+          << "        <Topology TopologyType=\"Triangle\" NumberOfElements=\"" << nel << "\">\n"
+          << "          <DataItem Dimensions=\"" << nel << " 3\" NumberType=\"Int\" Precision=\"4\" Format=\"Binary\">"
+          << "topology.bin</DataItem>\n"
+          << "        </Topology>\n"
+          << "        <Geometry GeometryType=\"XYZ\">\n";
+    dataItem(nn, 3);
+    m_xml << "        </Geometry>\n";
+    if (m_fields & VELOCITY)
+        attribute("velocity", true, nn, 3);
+    if (m_fields & FORCE)
+        attribute("residual_force", true, nn, 3);
+    if (m_fields & STRAIN)
+        attribute("area_strain", false, nel, 1);
+    if (m_fields & BENDING)
+        attribute("bending_energy", false, nel, 1);
+    m_xml << "      </Grid>\n";
+    m_tail = m_xml.tellp();
+}
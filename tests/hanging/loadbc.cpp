@@ -69,15 +69,15 @@ void Boundary::initBC() {
     //      m_dirichletDofs.push_back(i+mid_dof + 9*m_SimGeo->num_nodes_len());
     //  }
 
-    //* sort the array for Dirichlet dofs
-    std::sort(m_dirichletDofs.begin(), m_dirichletDofs.end());
+    //* sort the array for Dirichlet dofs, build the lookup mask
+    findDirichletMask();
 }
 
 // configure external force
 void Boundary::configForce(const Sets& t_set) {
     for (auto inode = t_set.m_nodes.begin(); inode != t_set.m_nodes.end(); inode++) {
         for (int dir = 0; dir <= 2; dir++) {
-            m_fext(m_SimGeo->nsd()*(*inode-1) + dir) = t_set.m_force[dir];
+            m_fext(m_SimGeo->nsd()*m_SimGeo->newNode(*inode-1) + dir) = t_set.m_force[dir];
         }
     }
 }
@@ -100,7 +100,21 @@ void Boundary::findDirichletDofs(const Sets& t_set) {
     }
 }
 
-bool Boundary::inDirichletBC(int index) {
-    auto iter = find(m_dirichletDofs.begin(), m_dirichletDofs.end(), index);
-    return !(iter == m_dirichletDofs.end());
+// renumber the Dirichlet dofs if the nodes are reordered, sort them, remove duplicates,
+// and mark them in the mask
+void Boundary::findDirichletMask() {
+    for (int &index : m_dirichletDofs) {
+        int node = index / m_SimGeo->nsd();
+        index += m_SimGeo->nsd() * (m_SimGeo->newNode(node) - node);
+    }
+    std::sort(m_dirichletDofs.begin(), m_dirichletDofs.end());
+    m_dirichletDofs.erase(std::unique(m_dirichletDofs.begin(), m_dirichletDofs.end()), m_dirichletDofs.end());
+
+    m_dirichletMask.assign(m_SimGeo->nn() * m_SimGeo->nsd(), false);
+    for (int index : m_dirichletDofs)
+        m_dirichletMask[index] = true;
+}
+
+bool Boundary::inDirichletBC(int index) const {
+    return m_dirichletMask[index];
 }
\ No newline at end of file
@@ -67,6 +67,7 @@ void PreProcessorImpl::PreProcess(Arguments t_args) {
     std::cout << "all lists building completed" << std::endl;
     m_SimGeo->findMassVector();
     std::cout << "mass calculated completed" << std::endl;
+    m_SimGeo->reorderNodes(m_SimPar->reorder_op());
     m_SimGeo->writeConnectivity();
     std::cout << "connectivity file written, preprocessing completed\n" << std::endl;
 }
@@ -143,6 +144,52 @@ void PreProcessorImpl::readInput() {
                 m_SimPar->set_solver_op((bool) std::stoi(value_var));    // solver option
             else if (name_var == "info_style")
                 m_SimPar->set_info_style((bool) std::stoi(value_var));   // console output style
+            else if (name_var == "assemble_op")
+                m_SimPar->set_assemble_op(std::stoi(value_var));         // assembly option
+            else if (name_var == "linear_solver")
+                m_SimPar->set_linear_solver(std::stoi(value_var));       // linear solver
+            else if (name_var == "newton_op")
+                m_SimPar->set_newton_op(std::stoi(value_var));           // Newton option
+            else if (name_var == "refactor_ratio")
+                m_SimPar->set_refactor_ratio(std::stod(value_var));      // refactor threshold
+            else if (name_var == "inexact_newton")
+                m_SimPar->set_inexact_newton(std::stoi(value_var));      // inexact Newton option
+            else if (name_var == "forcing_max")
+                m_SimPar->set_forcing_max(std::stod(value_var));         // maximum forcing term
+            else if (name_var == "reorder_op")
+                m_SimPar->set_reorder_op(std::stoi(value_var));          // node reordering
+            else if (name_var == "adaptive_dt")
+                m_SimPar->set_adaptive_dt(std::stoi(value_var));         // adaptive step size
+            else if (name_var == "dt_min")
+                m_SimPar->set_dt_min(std::stod(value_var));              // smallest adaptive step size
+            else if (name_var == "dt_max")
+                m_SimPar->set_dt_max(std::stod(value_var));              // largest adaptive step size
+            else if (name_var == "integrator")
+                m_SimPar->set_integrator(std::stoi(value_var));          // time integrator
+            else if (name_var == "rho_inf")
+                m_SimPar->set_rho_inf(std::stod(value_var));             // spectral radius of generalized-alpha
+            else if (name_var == "pd_iter")
+                m_SimPar->set_pd_iter(std::stoi(value_var));             // projective dynamics iterations
+            else if (name_var == "relax_op")
+                m_SimPar->set_relax_op(std::stoi(value_var));            // static relaxation option
+            else if (name_var == "relax_iter")
+                m_SimPar->set_relax_iter(std::stoi(value_var));          // FIRE maximum iterations
+            else if (name_var == "predictor")
+                m_SimPar->set_predictor(std::stoi(value_var));           // predictor of the Newton initial guess
+            else if (name_var == "checkpoint_freq")
+                m_SimPar->set_checkpoint_freq(std::stoi(value_var));     // checkpoint frequency
+            else if (name_var == "out_format")
+                m_SimPar->set_out_format(std::stoi(value_var));          // output format
+            else if (name_var == "async_output")
+                m_SimPar->set_async_output(std::stoi(value_var));        // output writer
+            else if (name_var == "out_buffer")
+                m_SimPar->set_out_buffer(std::stoi(value_var));          // frames of the output buffer
+            else if (name_var == "out_keyframe")
+                m_SimPar->set_out_keyframe(std::stoi(value_var));        // keyframe interval
+            else if (name_var == "out_error")
+                m_SimPar->set_out_error(std::stod(value_var));           // error bound of the compressed output
+            else if (name_var == "out_fields")
+                m_SimPar->set_out_fields(std::stoi(value_var));          // fields of the XDMF export
         }
     }
     input_file.close();
@@ -310,6 +357,9 @@ void PreProcessorImpl::buildEdgeHingeList() {
             m_SimGeo->m_hingeList.emplace_back(this_element->build_hinges(key, adj_element));
         }
     }
+    // flatten the lists into the topology arrays used by the solver
+    m_SimGeo->buildTopology();
+
     // NOTE: edge/hinge number check only works for structured rectangular mesh
     assert(m_SimGeo->edgeNumCheck());
     assert(m_SimGeo->hingeNumCheck());
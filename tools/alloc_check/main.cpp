@@ -0,0 +1,108 @@
+/*
+ *      Heap allocations of the stencil kernels
+ *
+ *      alloc_check [ncall]
+ *
+ *      calls the stretching, shearing and bending kernels ncall times each, with and without
+ *      the local jacobian, and counts the calls of malloc (operator new and Eigen allocate
+ *      through malloc). Exits with 1 if any kernel allocates.
+ *      Counting replaces malloc of glibc, other platforms are not supported.
+ */
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "stretching.h"
+#include "shearing.h"
+#include "bending.h"
+
+#ifdef __GLIBC__
+extern "C" void* __libc_malloc(size_t size);
+
+static long g_mallocs = 0;
+
+extern "C" void* malloc(size_t size) {
+    g_mallocs++;
+    return __libc_malloc(size);
+}
+#endif
+
+// number of mallocs of ncall calls of kernel
+template <typename Kernel>
+static long countMallocs(const int ncall, Kernel kernel) {
+    kernel(0);
+    long start = g_mallocs;
+    for (int i = 0; i < ncall; i++)
+        kernel(i);
+    return g_mallocs - start;
+}
+
+int main(int argc, char* argv[]) {
+#ifndef __GLIBC__
+    std::cerr << "alloc_check counts the calls of malloc of glibc" << std::endl;
+    return 1;
+#else
+    int ncall = (argc > 1) ? std::stoi(argv[1]) : 100000;
+
+    // a bent hinge, the positions change with the call so that nothing is hoisted out of the loop
+    Eigen::Vector3d x0(0.0, 0.0, 0.0), x1(1.0, 0.0, 0.0), x2(0.4, 0.9, 0.1), x3(0.6, -0.8, 0.2);
+    auto shift = [] (int i) { return Eigen::Vector3d(1e-9 * (i % 7), 0.0, 1e-9 * (i % 5)); };
+
+    double sink = 0.0;
+    Vector6d f6;   Matrix6d j6;
+    Vector9d f9;   Matrix9d j9;
+    Vector12d f12; Matrix12d j12;
+
+    long counts[] = {
+        countMallocs(ncall, [&] (int i) {
+            Stretching E(x0, x1 + shift(i), 1.0, 1.0);
+            E.locStretch(f6, j6);
+            sink += f6(0) + j6(0,0);
+        }),
+        countMallocs(ncall, [&] (int i) {
+            Stretching E(x0, x1 + shift(i), 1.0, 1.0);
+            E.locStretch(f6);
+            sink += f6(0);
+        }),
+        countMallocs(ncall, [&] (int i) {
+            Shearing E(x0, x1 + shift(i), x2, 1.0, 1.0);
+            E.locShear(f9, j9);
+            sink += f9(0) + j9(0,0);
+        }),
+        countMallocs(ncall, [&] (int i) {
+            Shearing E(x0, x1 + shift(i), x2, 1.0, 1.0);
+            E.locShear(f9);
+            sink += f9(0);
+        }),
+        countMallocs(ncall, [&] (int i) {
+            Bending E(x0, x1, x2 + shift(i), x3, 1.0, 0.0);
+            E.locBend(f12, j12);
+            sink += f12(0) + j12(0,0);
+        }),
+        countMallocs(ncall, [&] (int i) {
+            Bending E(x0, x1, x2 + shift(i), x3, 1.0, 0.0);
+            E.locBend(f12);
+            sink += f12(0);
+        }),
+        countMallocs(ncall / BendingBatch::LANES, [&] (int i) {
+            BendingBatch E;
+            for (int l = 0; l < BendingBatch::LANES; l++)
+                E.setHinge(l, x0, x1, x2 + shift(i + l), x3, 1.0, 0.0);
+            E.compute(true);
+            E.locBend(0, f12, j12);
+            sink += f12(0) + j12(0,0);
+        }),
+    };
+    const char* names[] = {"stretching", "stretching, force only", "shearing", "shearing, force only",
+                           "bending", "bending, force only", "bending, batch of hinges"};
+
+    long total = 0;
+    for (int k = 0; k < 7; k++) {
+        std::cout << names[k] << ": " << counts[k] << " allocations" << std::endl;
+        total += counts[k];
+    }
+    std::cout << "checksum " << sink << std::endl;
+    return (total == 0) ? 0 : 1;
+#endif
+}
@@ -0,0 +1,93 @@
+/*
+ *      Decoder of the compressed trajectory (out_format = 3)
+ *
+ *      decode_trajectory trajectory.psz [trajectory.bin]
+ *
+ *      writes the float64 binary trajectory of out_format = 1, see trajectory_writer.h,
+ *      which is memory mapped by readTrajectory() of PyPost.py
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#include "trajectory_codec.h"
+
+template <typename T>
+static void read(std::ifstream& in, T* data, const size_t n) {
+    in.read(reinterpret_cast<char*>(data), n * sizeof(T));
+    if (!in)
+        throw "unexpected end of the compressed trajectory";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: decode_trajectory trajectory.psz [trajectory.bin]" << std::endl;
+        return 1;
+    }
+    std::string output = (argc == 3) ? argv[2] : "trajectory.bin";
+
+    try {
+        std::ifstream in(argv[1], std::ios::binary);
+        if (!in)
+            throw "cannot open the compressed trajectory";
+        char magic[8];
+        read(in, magic, 8);
+        if (std::memcmp(magic, TrajectoryCodec::MAGIC, 8) != 0)
+            throw "not a compressed trajectory";
+
+        int32_t header[4];
+        double h;
+        read(in, header, 4);
+        read(in, &h, 1);
+        int nn = header[0], nel = header[1], nen = header[2];
+        std::vector<int32_t> conn(nel * nen + (nel * nen) % 2);
+        read(in, conn.data(), conn.size());
+
+        std::ofstream out(output.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            throw "cannot open the output file";
+        const char magic_out[8] = {'P', 'S', 'T', 'R', 'A', 'J', '0', '1'};
+        int32_t header_out[4] = {nn, nel, nen, 8};
+        out.write(magic_out, 8);
+        out.write(reinterpret_cast<const char*>(header_out), sizeof(header_out));
+        out.write(reinterpret_cast<const char*>(conn.data()), conn.size() * sizeof(int32_t));
+
+        std::vector<int64_t> q(3 * nn), q1, q2;
+        std::vector<uint8_t> bytes;
+        std::vector<double> coord(3 * nn);
+        int nframe = 0;
+        int64_t step;
+        while (in.read(reinterpret_cast<char*>(&step), sizeof(int64_t))) {
+            int32_t record[2];
+            read(in, record, 2);
+            if (record[0] < 0 || record[0] > 2 || (record[0] > 0 && q1.empty()) || (record[0] > 1 && q2.empty()))
+                throw "corrupted frame of the compressed trajectory";
+            bytes.resize(record[1]);
+            read(in, bytes.data(), bytes.size());
+            TrajectoryCodec::decodeFrame(bytes.data(), bytes.size(), q1, q2, record[0], q);
+
+            // component-major to node-major
+            for (int k = 0; k < nn; k++) {
+                for (int j = 0; j < 3; j++)
+                    coord[3*k + j] = h * q[j * nn + k];
+            }
+            out.write(reinterpret_cast<const char*>(&step), sizeof(int64_t));
+            out.write(reinterpret_cast<const char*>(coord.data()), coord.size() * sizeof(double));
+
+            q2.swap(q1);
+            q1 = q;
+            nframe++;
+        }
+        if (!out)
+            throw "writing the output file failed";
+        std::cout << nframe << " frames of " << nn << " nodes decoded, error bound " << 0.5 * h << std::endl;
+    }
+    catch (const char* msg) {
+        std::cerr << msg << std::endl;
+        return 1;
+    }
+    return 0;
+}